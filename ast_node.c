@@ -0,0 +1,566 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ast_node.h"
+#include "free_threading.h"
+#include "stats.h"
+
+#if PY_MAJOR_VERSION >= 3
+  #define PYCYPHER_INTERN_STRING PyUnicode_InternFromString
+  #define PYCYPHER_STRING_AS_UTF8 PyUnicode_AsUTF8
+  #define PYCYPHER_BIND_METHOD(func, self, cls) PyMethod_New(func, self)
+#else
+  #define PYCYPHER_INTERN_STRING PyString_InternFromString
+  #define PYCYPHER_STRING_AS_UTF8 PyString_AsString
+  #define PYCYPHER_BIND_METHOD(func, self, cls) PyMethod_New(func, self, cls)
+#endif
+
+static PyObject* pycypher_id_key;
+static PyObject* pycypher_role_key;
+static PyObject* pycypher_props_attr;
+static PyObject* pycypher_role_nodes_attr;
+static PyObject* pycypher_roles_attr;
+
+static int pycypher_AstNode_traverse(pycypher_AstNode* self, visitproc visit, void* arg) {
+  Py_VISIT(self->id);
+  Py_VISIT(self->type);
+  Py_VISIT(self->instanceof);
+  Py_VISIT(self->children);
+  Py_VISIT(self->props);
+  Py_VISIT(self->roles);
+  Py_VISIT(self->role_nodes);
+  Py_VISIT(self->parent);
+  return 0;
+}
+
+static int pycypher_AstNode_clear(pycypher_AstNode* self) {
+  Py_CLEAR(self->id);
+  Py_CLEAR(self->type);
+  Py_CLEAR(self->instanceof);
+  Py_CLEAR(self->children);
+  Py_CLEAR(self->props);
+  Py_CLEAR(self->roles);
+  Py_CLEAR(self->role_nodes);
+  Py_CLEAR(self->parent);
+  return 0;
+}
+
+static void pycypher_AstNode_dealloc(pycypher_AstNode* self) {
+  PyObject_GC_UnTrack(self);
+  if(self->weakreflist != NULL)
+    PyObject_ClearWeakRefs((PyObject*)self);
+  pycypher_AstNode_clear(self);
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/* Return a new reference to a field of the node, read from its slot unless
+a subclass (LazyCypherAstNode) provides it in another way.
+*/
+static PyObject* pycypher_node_field(
+  PyObject* node, PyObject* value, PyObject* attr
+) {
+  if(value != NULL) {
+    Py_INCREF(value);
+    return value;
+  }
+  return PyObject_GetAttr(node, attr);
+}
+
+static int pycypher_add_child_role(
+  pycypher_AstNode* self, PyObject* index, PyObject* ref
+) {
+  PyObject* id = PyDict_Check(ref) ? PyDict_GetItem(ref, pycypher_id_key) : NULL;
+  PyObject* role = PyDict_Check(ref) ? PyDict_GetItem(ref, pycypher_role_key) : NULL;
+  if(id == NULL || role == NULL) {
+    PyErr_SetString(PyExc_ValueError, "Malformed reference to a child.");
+    return -1;
+  }
+  PyObject* node = PyDict_GetItem(index, id);
+  if(node == NULL) {
+    PyErr_Format(
+      PyExc_ValueError, "Child with id %ld not found.", PyLong_AsLong(id)
+    );
+    return -1;
+  }
+  return pycypher_add_role(self, node, role);
+}
+
+int pycypher_add_role(pycypher_AstNode* self, PyObject* node, PyObject* role) {
+  PyObject* roles = PyObject_TypeCheck(node, &pycypher_AstNodeType)
+    ? pycypher_node_field(node, ((pycypher_AstNode*)node)->roles, pycypher_roles_attr)
+    : PyObject_GetAttr(node, pycypher_roles_attr);
+  if(roles == NULL)
+    return -1;
+  int result = PyList_Append(roles, role);
+  Py_DECREF(roles);
+  if(result < 0)
+    return -1;
+  if(self->role_nodes == NULL &&
+      (self->role_nodes = pycypher_stats_allocated(PyDict_New())) == NULL)
+    return -1;
+  PyObject* nodes = PyDict_GetItem(self->role_nodes, role);
+  if(nodes == NULL) {
+    nodes = pycypher_stats_allocated(PyList_New(0));
+    if(nodes == NULL || PyDict_SetItem(self->role_nodes, role, nodes) < 0) {
+      Py_XDECREF(nodes);
+      return -1;
+    }
+    Py_DECREF(nodes);
+  }
+  return PyList_Append(nodes, node);
+}
+
+/* Same as CypherAstNode._init_props. */
+static int pycypher_init_props(pycypher_AstNode* self, PyObject* index) {
+  PyObject* removed = PyList_New(0);
+  PyObject* key;
+  PyObject* value;
+  Py_ssize_t pos = 0;
+  Py_ssize_t i;
+  if(removed == NULL)
+    return -1;
+  while(PyDict_Next(self->props, &pos, &key, &value)) {
+    if(PyDict_Check(value)) {
+      if(pycypher_add_child_role(self, index, value) < 0)
+        goto error;
+    } else if(PyList_Check(value)) {
+      Py_ssize_t n = PyList_GET_SIZE(value);
+      if(n > 0 && !PyDict_Check(PyList_GET_ITEM(value, 0)))
+        continue;
+      for(i=0; i<n; ++i)
+        if(pycypher_add_child_role(self, index, PyList_GET_ITEM(value, i)) < 0)
+          goto error;
+    } else {
+      continue;
+    }
+    if(PyList_Append(removed, key) < 0)
+      goto error;
+  }
+  // The dict can't change size while iterating over it.
+  for(i=0; i<PyList_GET_SIZE(removed); ++i)
+    if(PyDict_DelItem(self->props, PyList_GET_ITEM(removed, i)) < 0)
+      goto error;
+  Py_DECREF(removed);
+  return 0;
+
+error:
+  Py_DECREF(removed);
+  return -1;
+}
+
+/* Replace the parent of the node by parent, which may be NULL. */
+static void pycypher_set_parent(pycypher_AstNode* node, PyObject* parent) {
+  PyObject* previous;
+  Py_XINCREF(parent);
+  PYCYPHER_BEGIN_CRITICAL_SECTION(node);
+  previous = node->parent;
+  node->parent = parent;
+  PYCYPHER_END_CRITICAL_SECTION();
+  Py_XDECREF(previous);
+}
+
+/* Make the node the parent of its children, like CypherAstNode.__init__. */
+static void pycypher_adopt_children(pycypher_AstNode* self) {
+  Py_ssize_t n = PyTuple_GET_SIZE(self->children);
+  Py_ssize_t i;
+  for(i=0; i<n; ++i) {
+    PyObject* child = PyTuple_GET_ITEM(self->children, i);
+    if(PyObject_TypeCheck(child, &pycypher_AstNodeType))
+      pycypher_set_parent((pycypher_AstNode*)child, (PyObject*)self);
+  }
+}
+
+PyObject* pycypher_new_ast_node(
+  PyTypeObject* cls, PyObject* id, PyObject* type, PyObject* instanceof,
+  PyObject* children, PyObject* props, Py_ssize_t start, Py_ssize_t end,
+  PyObject* index, Py_hash_t hash, Py_ssize_t depth
+) {
+  pycypher_AstNode* self = (pycypher_AstNode*)cls->tp_alloc(cls, 0);
+  if(self == NULL) {
+    Py_DECREF(children);
+    Py_XDECREF(props);
+    return NULL;
+  }
+  Py_INCREF(id);
+  self->id = id;
+  Py_INCREF(type);
+  self->type = type;
+  Py_INCREF(instanceof);
+  self->instanceof = instanceof;
+  self->children = children;
+  self->props = props;
+  self->start = start;
+  self->end = end;
+  self->hash = hash;
+  self->has_hash = 1;
+  self->own_props = 1;
+  self->depth = depth;
+  self->has_depth = 1;
+  pycypher_adopt_children(self);
+  if((self->roles = pycypher_stats_allocated(PyList_New(0))) == NULL ||
+      (index != NULL && (pycypher_init_props(self, index) < 0 ||
+        PyDict_SetItem(index, id, (PyObject*)self) < 0))) {
+    Py_DECREF(self);
+    return NULL;
+  }
+  return (PyObject*)self;
+}
+
+static PyMemberDef pycypher_AstNode_members[] = {
+  {"_id", T_OBJECT_EX, offsetof(pycypher_AstNode, id), 0, NULL},
+  {"_type", T_OBJECT_EX, offsetof(pycypher_AstNode, type), 0, NULL},
+  {"_instanceof", T_OBJECT_EX, offsetof(pycypher_AstNode, instanceof), 0, NULL},
+  {"_children", T_OBJECT_EX, offsetof(pycypher_AstNode, children), 0, NULL},
+  {"_roles", T_OBJECT_EX, offsetof(pycypher_AstNode, roles), 0, NULL},
+  {"_start", T_PYSSIZET, offsetof(pycypher_AstNode, start), 0, NULL},
+  {"_end", T_PYSSIZET, offsetof(pycypher_AstNode, end), 0, NULL},
+  {NULL}
+};
+
+static PyObject* pycypher_AstNode_get_props(pycypher_AstNode* self, void* closure) {
+  PyObject* result;
+  PYCYPHER_BEGIN_CRITICAL_SECTION(self);
+  if(self->props == NULL && self->own_props)
+    self->props = pycypher_stats_allocated(PyDict_New());
+  result = self->props;
+  Py_XINCREF(result);
+  PYCYPHER_END_CRITICAL_SECTION();
+  if(result == NULL && !PyErr_Occurred())
+    PyErr_SetString(PyExc_AttributeError, "_props");
+  return result;
+}
+
+static int pycypher_AstNode_set_props(
+  pycypher_AstNode* self, PyObject* value, void* closure
+) {
+  PYCYPHER_BEGIN_CRITICAL_SECTION(self);
+  PyObject* previous = self->props;
+  Py_XINCREF(value);
+  self->props = value;
+  self->own_props = value != NULL;
+  Py_XDECREF(previous);
+  PYCYPHER_END_CRITICAL_SECTION();
+  return 0;
+}
+
+static PyObject* pycypher_AstNode_get_role_nodes(pycypher_AstNode* self, void* closure) {
+  PyObject* result;
+  PYCYPHER_BEGIN_CRITICAL_SECTION(self);
+  if(self->role_nodes == NULL)
+    self->role_nodes = pycypher_stats_allocated(PyDict_New());
+  result = self->role_nodes;
+  Py_XINCREF(result);
+  PYCYPHER_END_CRITICAL_SECTION();
+  return result;
+}
+
+static int pycypher_AstNode_set_role_nodes(
+  pycypher_AstNode* self, PyObject* value, void* closure
+) {
+  PYCYPHER_BEGIN_CRITICAL_SECTION(self);
+  PyObject* previous = self->role_nodes;
+  Py_XINCREF(value);
+  self->role_nodes = value;
+  Py_XDECREF(previous);
+  PYCYPHER_END_CRITICAL_SECTION();
+  return 0;
+}
+
+static PyObject* pycypher_AstNode_get_hash(pycypher_AstNode* self, void* closure) {
+  int has_hash;
+  Py_hash_t hash;
+  PYCYPHER_BEGIN_CRITICAL_SECTION(self);
+  has_hash = self->has_hash;
+  hash = self->hash;
+  PYCYPHER_END_CRITICAL_SECTION();
+  if(!has_hash)
+    Py_RETURN_NONE;
+  return Py_BuildValue("n", (Py_ssize_t)hash);
+}
+
+static int pycypher_AstNode_set_hash(
+  pycypher_AstNode* self, PyObject* value, void* closure
+) {
+  Py_ssize_t hash = 0;
+  int has_hash = value != NULL && value != Py_None;
+  if(has_hash && (hash = PyNumber_AsSsize_t(value, PyExc_OverflowError)) == -1 &&
+      PyErr_Occurred())
+    return -1;
+  PYCYPHER_BEGIN_CRITICAL_SECTION(self);
+  self->hash = (Py_hash_t)hash;
+  self->has_hash = has_hash;
+  PYCYPHER_END_CRITICAL_SECTION();
+  return 0;
+}
+
+static PyObject* pycypher_AstNode_get_depth(pycypher_AstNode* self, void* closure) {
+  int has_depth;
+  Py_ssize_t depth;
+  PYCYPHER_BEGIN_CRITICAL_SECTION(self);
+  has_depth = self->has_depth;
+  depth = self->depth;
+  PYCYPHER_END_CRITICAL_SECTION();
+  if(!has_depth)
+    Py_RETURN_NONE;
+  return Py_BuildValue("n", depth);
+}
+
+static int pycypher_AstNode_set_depth(
+  pycypher_AstNode* self, PyObject* value, void* closure
+) {
+  Py_ssize_t depth = 0;
+  int has_depth = value != NULL && value != Py_None;
+  if(has_depth &&
+      (depth = PyNumber_AsSsize_t(value, PyExc_OverflowError)) == -1 &&
+      PyErr_Occurred())
+    return -1;
+  PYCYPHER_BEGIN_CRITICAL_SECTION(self);
+  self->depth = depth;
+  self->has_depth = has_depth;
+  PYCYPHER_END_CRITICAL_SECTION();
+  return 0;
+}
+
+static PyObject* pycypher_AstNode_get_parent(pycypher_AstNode* self, void* closure) {
+  PyObject* result;
+  PYCYPHER_BEGIN_CRITICAL_SECTION(self);
+  result = self->parent != NULL ? self->parent : Py_None;
+  Py_INCREF(result);
+  PYCYPHER_END_CRITICAL_SECTION();
+  return result;
+}
+
+static int pycypher_AstNode_set_parent(
+  pycypher_AstNode* self, PyObject* value, void* closure
+) {
+  pycypher_set_parent(self, value == Py_None ? NULL : value);
+  return 0;
+}
+
+static PyGetSetDef pycypher_AstNode_getset[] = {
+  {
+    "_props", (getter)pycypher_AstNode_get_props,
+    (setter)pycypher_AstNode_set_props, NULL, NULL
+  },
+  {
+    "_role_nodes", (getter)pycypher_AstNode_get_role_nodes,
+    (setter)pycypher_AstNode_set_role_nodes, NULL, NULL
+  },
+  {
+    "_hash", (getter)pycypher_AstNode_get_hash,
+    (setter)pycypher_AstNode_set_hash, NULL, NULL
+  },
+  {
+    "_parent", (getter)pycypher_AstNode_get_parent,
+    (setter)pycypher_AstNode_set_parent, NULL, NULL
+  },
+  {
+    "_depth", (getter)pycypher_AstNode_get_depth,
+    (setter)pycypher_AstNode_set_depth, NULL, NULL
+  },
+  {NULL}
+};
+
+PyTypeObject pycypher_AstNodeType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "pycypher.bindings.AstNode",           /* tp_name */
+  sizeof(pycypher_AstNode),              /* tp_basicsize */
+  0,                                     /* tp_itemsize */
+  (destructor)pycypher_AstNode_dealloc,  /* tp_dealloc */
+};
+
+/* A getter method of GettersMixin: returns the prop called name if the node
+has one, and otherwise the children in role, all of them for list getters
+and the only one or None for the others.
+*/
+typedef struct {
+  PyObject_HEAD
+  PyObject* name;
+  PyObject* role;
+  PyObject* method_name;
+  PyObject* doc;
+  int is_list;
+}
+pycypher_Getter;
+
+static void pycypher_Getter_dealloc(pycypher_Getter* self) {
+  Py_XDECREF(self->name);
+  Py_XDECREF(self->role);
+  Py_XDECREF(self->method_name);
+  Py_XDECREF(self->doc);
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* pycypher_Getter_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+  static char* kwlist[] = {"name", "role", "method_name", "doc", "is_list", NULL};
+  PyObject* name;
+  PyObject* role;
+  PyObject* method_name;
+  PyObject* doc = Py_None;
+  int is_list = 0;
+  if(!PyArg_ParseTupleAndKeywords(
+      args, kwargs, "OOO|Oi:Getter", kwlist,
+      &name, &role, &method_name, &doc, &is_list
+  ))
+    return NULL;
+  pycypher_Getter* self = (pycypher_Getter*)type->tp_alloc(type, 0);
+  if(self == NULL)
+    return NULL;
+  Py_INCREF(name);
+  self->name = name;
+  Py_INCREF(role);
+  self->role = role;
+  Py_INCREF(method_name);
+  self->method_name = method_name;
+  Py_INCREF(doc);
+  self->doc = doc;
+  self->is_list = is_list;
+  return (PyObject*)self;
+}
+
+static PyObject* pycypher_Getter_get(pycypher_Getter* self, PyObject* node) {
+  PyObject* props;
+  PyObject* role_nodes;
+  PyObject* result = NULL;
+  int own_props = 0;
+  if(PyObject_TypeCheck(node, &pycypher_AstNodeType)) {
+    // Nodes built by the bindings only get props once they have one, and
+    // role_nodes once a child has a role.
+    PYCYPHER_BEGIN_CRITICAL_SECTION(node);
+    own_props = ((pycypher_AstNode*)node)->own_props;
+    props = ((pycypher_AstNode*)node)->props;
+    Py_XINCREF(props);
+    role_nodes = ((pycypher_AstNode*)node)->role_nodes;
+    Py_XINCREF(role_nodes);
+    PYCYPHER_END_CRITICAL_SECTION();
+    if(!own_props) {
+      Py_XDECREF(props);
+      Py_XDECREF(role_nodes);
+    }
+  }
+  if(!own_props) {
+    if((props = PyObject_GetAttr(node, pycypher_props_attr)) == NULL)
+      return NULL;
+    if((role_nodes = PyObject_GetAttr(node, pycypher_role_nodes_attr)) == NULL)
+      goto cleanup;
+  }
+
+  if(props != NULL && PyDict_CheckExact(props)) {
+    result = PyDict_GetItem(props, self->name);
+    Py_XINCREF(result);
+    if(result != NULL)
+      goto cleanup;
+  } else if(props != NULL) {
+    result = PyObject_GetItem(props, self->name);
+    if(result != NULL || !PyErr_ExceptionMatches(PyExc_KeyError))
+      goto cleanup;
+    PyErr_Clear();
+  }
+  PyObject* nodes = role_nodes == NULL
+    ? NULL
+    : PyDict_GetItem(role_nodes, self->role);
+  Py_ssize_t n = nodes == NULL ? 0 : PySequence_Size(nodes);
+  if(n < 0)
+    goto cleanup;
+  if(self->is_list) {
+    result = nodes == NULL ? PyList_New(0) : PySequence_List(nodes);
+  } else if(n == 0) {
+    Py_INCREF(Py_None);
+    result = Py_None;
+  } else if(n == 1) {
+    result = PySequence_GetItem(nodes, 0);
+  } else {
+    const char* role = PYCYPHER_STRING_AS_UTF8(self->role);
+    if(role != NULL)
+      PyErr_Format(
+        PyExc_ValueError, "Multiple children with singleton role \"%s\".", role
+      );
+  }
+
+cleanup:
+  Py_XDECREF(props);
+  Py_XDECREF(role_nodes);
+  return result;
+}
+
+static PyObject* pycypher_Getter_call(pycypher_Getter* self, PyObject* args, PyObject* kwargs) {
+  PyObject* node;
+  if(!PyArg_ParseTuple(args, "O", &node))
+    return NULL;
+  return pycypher_Getter_get(self, node);
+}
+
+static PyObject* pycypher_Getter_descr_get(PyObject* self, PyObject* obj, PyObject* cls) {
+  if(obj == NULL || obj == Py_None) {
+    Py_INCREF(self);
+    return self;
+  }
+  return PYCYPHER_BIND_METHOD(self, obj, cls);
+}
+
+static PyMemberDef pycypher_Getter_members[] = {
+  {"name", T_OBJECT, offsetof(pycypher_Getter, name), READONLY, NULL},
+  {"role", T_OBJECT, offsetof(pycypher_Getter, role), READONLY, NULL},
+  {"__name__", T_OBJECT, offsetof(pycypher_Getter, method_name), READONLY, NULL},
+  {"__doc__", T_OBJECT, offsetof(pycypher_Getter, doc), READONLY, NULL},
+  {NULL}
+};
+
+PyTypeObject pycypher_GetterType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "pycypher.bindings.Getter",           /* tp_name */
+  sizeof(pycypher_Getter),              /* tp_basicsize */
+  0,                                    /* tp_itemsize */
+  (destructor)pycypher_Getter_dealloc,  /* tp_dealloc */
+};
+
+static int pycypher_add_type(PyObject* module, const char* name, PyTypeObject* type) {
+  if(PyType_Ready(type) < 0)
+    return -1;
+  Py_INCREF(type);
+  if(PyModule_AddObject(module, name, (PyObject*)type) < 0) {
+    Py_DECREF(type);
+    return -1;
+  }
+  return 0;
+}
+
+int pycypher_init_ast_node(PyObject* module) {
+  if((pycypher_id_key = PYCYPHER_INTERN_STRING("id")) == NULL ||
+      (pycypher_role_key = PYCYPHER_INTERN_STRING("role")) == NULL ||
+      (pycypher_props_attr = PYCYPHER_INTERN_STRING("_props")) == NULL ||
+      (pycypher_role_nodes_attr = PYCYPHER_INTERN_STRING("_role_nodes")) == NULL ||
+      (pycypher_roles_attr = PYCYPHER_INTERN_STRING("_roles")) == NULL)
+    return -1;
+
+  pycypher_AstNodeType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE |
+    Py_TPFLAGS_HAVE_GC;
+  pycypher_AstNodeType.tp_doc = "Native base of CypherAstNode.";
+  pycypher_AstNodeType.tp_traverse = (traverseproc)pycypher_AstNode_traverse;
+  pycypher_AstNodeType.tp_clear = (inquiry)pycypher_AstNode_clear;
+  pycypher_AstNodeType.tp_members = pycypher_AstNode_members;
+  pycypher_AstNodeType.tp_getset = pycypher_AstNode_getset;
+  pycypher_AstNodeType.tp_weaklistoffset = offsetof(pycypher_AstNode, weakreflist);
+  pycypher_AstNodeType.tp_new = PyType_GenericNew;
+  if(pycypher_add_type(module, "AstNode", &pycypher_AstNodeType) < 0)
+    return -1;
+
+  pycypher_GetterType.tp_flags = Py_TPFLAGS_DEFAULT;
+  pycypher_GetterType.tp_doc = "Native getter method of GettersMixin.";
+  pycypher_GetterType.tp_call = (ternaryfunc)pycypher_Getter_call;
+  pycypher_GetterType.tp_descr_get = pycypher_Getter_descr_get;
+  pycypher_GetterType.tp_members = pycypher_Getter_members;
+  pycypher_GetterType.tp_new = pycypher_Getter_new;
+  return pycypher_add_type(module, "Getter", &pycypher_GetterType);
+}
@@ -0,0 +1,89 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_AST_NODE_H
+#define PYCYPHER_AST_NODE_H
+#include <Python.h>
+#include <structmember.h>
+#include "structural_hash.h"
+
+/* Native base of CypherAstNode, holding its fields in fixed slots instead of
+an instance dict:
+
+ - id, type, instanceof, children (a tuple), props, start and end as given
+   to the CypherAstNode constructor
+ - roles: the roles of the node in the props of its parent
+ - role_nodes: a dict from a role to the list of children in that role,
+   only created once a child is added to it or it's accessed from Python
+ - props of nodes built by the bindings is likewise NULL until a prop is
+   set or it's accessed from Python, if own_props is set
+ - hash: the structural hash of the subtree, see structural_hash.h, if
+   has_hash is set
+ - parent: the node whose children include this one, or NULL for roots. It's
+   a strong reference, so trees are cycles freed by the garbage collector and
+   any node keeps its ancestors alive
+ - depth: the number of ancestors of the node, if has_depth is set, which it
+   is for nodes built by the bindings
+
+Fields are exposed to Python with a leading underscore (node._props) so that
+CypherAstNode and its subclasses can keep treating them as attributes. The
+bindings build instances of subclasses directly, without calling __init__.
+*/
+typedef struct {
+  PyObject_HEAD
+  PyObject* id;
+  PyObject* type;
+  PyObject* instanceof;
+  PyObject* children;
+  PyObject* props;
+  PyObject* roles;
+  PyObject* role_nodes;
+  Py_hash_t hash;
+  int has_hash;
+  int own_props;
+  PyObject* parent;
+  Py_ssize_t depth;
+  int has_depth;
+  Py_ssize_t start;
+  Py_ssize_t end;
+  PyObject* weakreflist;
+}
+pycypher_AstNode;
+
+extern PyTypeObject pycypher_AstNodeType;
+extern PyTypeObject pycypher_GetterType;
+
+/* Return a new node of cls, a subtype of pycypher_AstNodeType, stealing the
+references to children and props. AST props are moved from props to the
+roles of the children they refer to, which are looked up in index, and the
+node is added to index under id, exactly like CypherAstNode.__init__ does.
+If index is NULL, props may be NULL and must not hold AST props, whose roles
+are then added with pycypher_add_role. The node becomes the parent of its
+children and has the given depth.
+*/
+PyObject* pycypher_new_ast_node(
+  PyTypeObject* cls, PyObject* id, PyObject* type, PyObject* instanceof,
+  PyObject* children, PyObject* props, Py_ssize_t start, Py_ssize_t end,
+  PyObject* index, Py_hash_t hash, Py_ssize_t depth
+);
+
+/* Give the child the role in the parent, like CypherAstNode._add_child_role
+does once it found the child. Return -1 on failure.
+*/
+int pycypher_add_role(pycypher_AstNode* parent, PyObject* child, PyObject* role);
+
+/* Ready the types and add them to the module. Return -1 on failure. */
+int pycypher_init_ast_node(PyObject* module);
+
+#endif
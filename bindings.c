@@ -13,48 +13,265 @@
  * limitations under the License.
  */
 #include "parser.h"
+#include "lazy.h"
+#include "flat.h"
+#include "serialize.h"
+#include "fingerprint.h"
+#include "ingest.h"
+#include "stream.h"
+#include "parser_options.h"
+#include "traverse.h"
+#include "matcher.h"
+#include "literals.h"
+#include "structural_hash.h"
+#include "stats.h"
+#include "ast_node.h"
 #include "node_types.h"
+#include "node_type_info.h"
 #include "operators.h"
 #include "props.h"
+#include "extract_props.h"
 
 static PyMethodDef pycypher_methods[] = {
     {
       "parse_query", pycypher_parse_query, METH_VARARGS,
       "Return a list of CypherAst instances corresponding to parsed query."
     },
+    {
+      "parse_queries", pycypher_parse_queries, METH_VARARGS,
+      "Parse a sequence of queries on a pool of native threads and return a"
+      " list of (asts, errors) tuples in input order."
+    },
+    {
+      "validate", pycypher_validate_query, METH_VARARGS,
+      "Parse the query without building any AST and return a list of errors,"
+      " the number of nodes and the number of directives."
+    },
+    {
+      "parse_buffer", pycypher_parse_buffer, METH_VARARGS,
+      "Return a list of CypherAst instances and a list of errors for the"
+      " query in an object supporting the buffer protocol."
+    },
+    {
+      "parse_fd", pycypher_parse_fd, METH_VARARGS,
+      "Return a list of CypherAst instances and a list of errors for the"
+      " whole file behind a file descriptor."
+    },
+    {
+      "iter_buffer", pycypher_iter_buffer, METH_VARARGS,
+      "Return an iterator of (ast, errors) tuples, one per directive of the"
+      " query in an object supporting the buffer protocol, optionally"
+      " starting at the given offset, line and column."
+    },
+    {
+      "iter_fd", pycypher_iter_fd, METH_VARARGS,
+      "Return an iterator of (ast, errors) tuples, one per directive of the"
+      " file behind a file descriptor, or None if it can't be mapped."
+    },
+    {
+      "traverse", pycypher_traverse_nodes, METH_VARARGS,
+      "Return or call back on the nodes of a CypherAstNode subtree matching"
+      " the filters, see CypherAstNode.traverse."
+    },
+    {
+      "parse_query_lazy", pycypher_parse_query_lazy, METH_VARARGS,
+      "Return a list of AstNodeRef instances for the roots of parsed query."
+    },
+    {
+      "parse_query_flat", pycypher_parse_query_flat, METH_VARARGS,
+      "Return a dict of flat arrays describing the parsed query."
+    },
+    {
+      "extract_literals", pycypher_extract_literals, METH_VARARGS,
+      "Return a dict of flat arrays describing the literals and parameters of"
+      " the query, with a template of it, and a list of errors."
+    },
+    {
+      "dump_query", pycypher_dump_query, METH_VARARGS,
+      "Parse the query and return the result in the binary AST format."
+    },
+    {
+      "load_query", pycypher_load_query, METH_VARARGS,
+      "Return a list of CypherAst instances and a list of errors loaded from"
+      " the binary AST format."
+    },
+    {
+      "fingerprint_query", pycypher_fingerprint_query, METH_VARARGS,
+      "Return the fingerprint of the query and the number of parse errors."
+    },
+    {
+      "scan_lines", pycypher_scan_lines, METH_VARARGS,
+      "Parse every non-blank line of a range of the buffer as a query and"
+      " return a dict of flat arrays describing the outcomes."
+    },
+    {
+      "structural_hash", pycypher_structural_hash, METH_VARARGS,
+      "Return the structural hash of a node given its type, props, the"
+      " structural hashes of its children and optionally, for each child,"
+      " the roles the node gives it."
+    },
+    {
+      "stats", pycypher_get_stats, METH_NOARGS,
+      "Return a dict of the counters and timers of the bindings."
+    },
+    {
+      "reset_stats", pycypher_reset_stats, METH_NOARGS,
+      "Set all counters and timers to zero."
+    },
+    {
+      "enable_stats", pycypher_enable_stats, METH_VARARGS,
+      "Turn counting and timing on or off, return whether it was on."
+    },
     {NULL, NULL, 0, NULL}
 };
 
 #if PY_MAJOR_VERSION >= 3
 
+  /* Types and tables are shared by every instance of the module and set up
+  by the first one. Besides the C tables, that includes Python objects: the
+  static types, interned names, instanceof tuples and prop names. These belong
+  to the interpreter that created them, so no other one may load the module.
+  That interpreter may still create several instances (e.g. when reimported
+  after being removed from sys.modules), later ones only get the types added.
+  Threads of free-threaded builds can create them concurrently, hence the
+  mutex.
+  */
+  static pthread_mutex_t pycypher_init_lock = PTHREAD_MUTEX_INITIALIZER;
+  static bool pycypher_initialized = false;
+#if PY_VERSION_HEX >= 0x03090000
+  static PyInterpreterState* pycypher_interpreter = NULL;
+#endif
+
+  static int pycypher_init_shared(PyObject* module) {
+    pycypher_init_node_types();
+    pycypher_init_operators();
+    pycypher_init_props();
+    if(pycypher_init_prop_names() < 0 ||
+        pycypher_init_node_type_info() < 0 || pycypher_init_lazy(module) < 0 ||
+        pycypher_init_stream() < 0 ||
+        pycypher_init_parser_options(module) < 0 ||
+        pycypher_init_traverse() < 0 ||
+        pycypher_init_matcher(module) < 0 ||
+        pycypher_init_ast_node(module) < 0)
+      return -1;
+    return 0;
+  }
+
+  static int pycypher_add_shared_type(
+    PyObject* module, const char* name, PyTypeObject* type
+  ) {
+    Py_INCREF(type);
+    if(PyModule_AddObject(module, name, (PyObject*)type) < 0) {
+      Py_DECREF(type);
+      return -1;
+    }
+    return 0;
+  }
+
+  static int pycypher_exec(PyObject* module) {
+    int result = 0;
+    if(pycypher_init_module_state(module) < 0)
+      return -1;
+    // Another interpreter holding the lock may need the GIL to finish.
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock(&pycypher_init_lock);
+    Py_END_ALLOW_THREADS
+    if(!pycypher_initialized) {
+      result = pycypher_init_shared(module);
+      pycypher_initialized = result == 0;
+#if PY_VERSION_HEX >= 0x03090000
+      pycypher_interpreter = PyInterpreterState_Get();
+    } else if(pycypher_interpreter != PyInterpreterState_Get()) {
+      PyErr_SetString(
+        PyExc_ImportError,
+        "pycypher.bindings can't be loaded by more than one interpreter"
+      );
+      result = -1;
+#endif
+    } else if(
+        pycypher_add_shared_type(module, "AstNodeRef", &pycypher_AstNodeRefType) < 0 ||
+        pycypher_add_shared_type(module, "Parser", &pycypher_ParserType) < 0 ||
+        pycypher_add_shared_type(module, "Matcher", &pycypher_MatcherType) < 0 ||
+        pycypher_add_shared_type(module, "AstNode", &pycypher_AstNodeType) < 0 ||
+        pycypher_add_shared_type(module, "Getter", &pycypher_GetterType) < 0) {
+      result = -1;
+    }
+    pthread_mutex_unlock(&pycypher_init_lock);
+    return result;
+  }
+
   static int pycypher_traverse(PyObject *m, visitproc visit, void *arg) {
     return 0;
   }
   static int pycypher_clear(PyObject *m) {
     return 0;
   }
+  static void pycypher_free(void *m) {
+    pycypher_free_module_state((PyObject*)m);
+  }
+
+#if PY_VERSION_HEX >= 0x03050000
+
+  /* Multi-phase initialization (PEP 489). The shared Python objects are
+  process-global, so subinterpreters can't load the module, see
+  pycypher_init_lock. Everything touched without the GIL is either read-only
+  after the first import or updated atomically, so free-threaded builds run
+  without the GIL.
+  */
+  static PyModuleDef_Slot pycypher_slots[] = {
+    {Py_mod_exec, pycypher_exec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_MULTIPLE_INTERPRETERS_NOT_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+  };
+
+  static struct PyModuleDef pycypher_module = {
+    PyModuleDef_HEAD_INIT,
+    "pycypher.bindings",
+    NULL,
+    sizeof(pycypher_module_state_t),
+    pycypher_methods,
+    pycypher_slots,
+    pycypher_traverse,
+    pycypher_clear,
+    pycypher_free
+  };
+  PyMODINIT_FUNC PyInit_bindings(void)
+  {
+    return PyModuleDef_Init(&pycypher_module);
+  }
+
+#else
+
   static struct PyModuleDef pycypher_module = {
     PyModuleDef_HEAD_INIT,
     "pycypher.bindings",
     NULL,
-    0,
+    sizeof(pycypher_module_state_t),
     pycypher_methods,
     NULL,
     pycypher_traverse,
     pycypher_clear,
-    NULL
+    pycypher_free
   };
   PyMODINIT_FUNC PyInit_bindings(void)
   {
     PyObject *module = PyModule_Create(&pycypher_module);
     if (module == NULL)
       return NULL;
-    pycypher_init_node_types();
-    pycypher_init_operators();
-    pycypher_init_props();
+    if(pycypher_exec(module) < 0) {
+      Py_DECREF(module);
+      return NULL;
+    }
     return module;
   }
 
+#endif
+
 #else
 
   PyMODINIT_FUNC initbindings(void)
@@ -65,6 +282,14 @@ static PyMethodDef pycypher_methods[] = {
     pycypher_init_node_types();
     pycypher_init_operators();
     pycypher_init_props();
+    pycypher_init_prop_names();
+    pycypher_init_node_type_info();
+    pycypher_init_lazy(module);
+    pycypher_init_stream();
+    pycypher_init_parser_options(module);
+    pycypher_init_traverse();
+    pycypher_init_matcher(module);
+    pycypher_init_ast_node(module);
   }
 
 #endif
@@ -0,0 +1,77 @@
+#!/usr/bin/env python
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Remove duplicate getters from a generated getters.py, in place.
+
+The generator emits one getter per prop of every node type, so getters of
+props shared by several node types are defined several times. Only the last
+definition of a name is bound by the class body; it is kept at the position
+of the first one.
+
+Usage: dedupe_getters.py getters.py
+"""
+
+import re
+import sys
+
+DEF = re.compile(r'^    def (\w+)\(')
+NOTE = '# Duplicate getters are removed by dedupe_getters.py\n'
+
+
+def dedupe(lines):
+    # The class body starts after the __slots__ line, every getter is a block
+    # of decorator, def and body lines starting at its first decorator. The
+    # last line of the file may lack its newline.
+    start = next(i for i, line in enumerate(lines)
+                 if line.strip() == '__slots__ = ()') + 1
+    header = lines[:start]
+    if NOTE not in header:
+        header.insert(1, NOTE)
+
+    blocks = []
+    block = []
+    for line in lines[start:]:
+        if not line.strip():
+            continue
+        if line.startswith('    @') and any(map(DEF.match, block)):
+            blocks.append(block)
+            block = []
+        block.append(line.rstrip('\n') + '\n')
+    if block:
+        blocks.append(block)
+
+    names = []
+    by_name = {}
+    for block in blocks:
+        name = next(m.group(1) for m in map(DEF.match, block) if m)
+        if name not in by_name:
+            names.append(name)
+        by_name[name] = block
+
+    result = header
+    for name in names:
+        result.append('\n')
+        result.extend(by_name[name])
+    return result
+
+
+def main(path):
+    with open(path) as f:
+        lines = f.readlines()
+    lines = dedupe(lines)
+    with open(path, 'w') as f:
+        f.writelines(lines)
+
+
+if __name__ == '__main__':
+    main(sys.argv[1])
@@ -12,42 +12,149 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <pthread.h>
 #include "extract_props.h"
+#include "stats.h"
 
-PyObject* pycypher_operator_to_python_string(const cypher_operator_t* op) {
+#if PY_MAJOR_VERSION >= 3
+  #define PYCYPHER_INTERN_STRING PyUnicode_InternFromString
+#else
+  #define PYCYPHER_INTERN_STRING PyString_InternFromString
+#endif
+
+/* Interned names of the entries of each prop table, indexed by kind and then
+by position in the table, roles of the entries of the AST list tables and
+names of operators. Created once per process and only read afterwards.
+*/
+static PyObject** pycypher_prop_names[PYCYPHER_AST_PROP + 1];
+static PyObject** pycypher_ast_list_roles;
+static PyObject** pycypher_ast_list_plus_one_roles;
+static PyObject** pycypher_operator_names;
+
+static PyObject** pycypher_intern_names(
+  const void* table, size_t len, size_t size, size_t offset
+) {
+  PyObject** result = malloc((len ? len : 1) * sizeof(PyObject*));
+  if(result == NULL) {
+    PyErr_NoMemory();
+    return NULL;
+  }
+  size_t i;
+  for(i=0; i<len; ++i) {
+    const char* name = *(const char* const*)((const char*)table + i * size + offset);
+    if((result[i] = PYCYPHER_INTERN_STRING(name)) == NULL) {
+      while(i > 0)
+        Py_DECREF(result[--i]);
+      free(result);
+      return NULL;
+    }
+  }
+  return result;
+}
+
+#define INTERN_NAMES(dest, table, type, field) \
+  (dest == NULL && (dest = pycypher_intern_names( \
+    table, table##_len, sizeof(type), offsetof(type, field) \
+  )) == NULL)
+
+int pycypher_init_prop_names(void) {
+  if(INTERN_NAMES(pycypher_prop_names[PYCYPHER_DIRECTION_PROP],
+        pycypher_direction_props, pycypher_direction_prop_t, name) ||
+      INTERN_NAMES(pycypher_prop_names[PYCYPHER_OPERATOR_PROP],
+        pycypher_operator_props, pycypher_operator_prop_t, name) ||
+      INTERN_NAMES(pycypher_prop_names[PYCYPHER_OPERATOR_LIST_PROP],
+        pycypher_operator_list_props, pycypher_operator_list_prop_t, name) ||
+      INTERN_NAMES(pycypher_prop_names[PYCYPHER_BOOL_PROP],
+        pycypher_bool_props, pycypher_bool_prop_t, name) ||
+      INTERN_NAMES(pycypher_prop_names[PYCYPHER_STRING_PROP],
+        pycypher_string_props, pycypher_string_prop_t, name) ||
+      INTERN_NAMES(pycypher_prop_names[PYCYPHER_AST_LIST_PROP],
+        pycypher_ast_list_props, pycypher_ast_list_prop_t, name) ||
+      INTERN_NAMES(pycypher_prop_names[PYCYPHER_AST_LIST_PLUS_ONE_PROP],
+        pycypher_ast_list_plus_one_props, pycypher_ast_list_plus_one_prop_t, name) ||
+      INTERN_NAMES(pycypher_prop_names[PYCYPHER_AST_PROP],
+        pycypher_ast_props, pycypher_ast_prop_t, name) ||
+      INTERN_NAMES(pycypher_ast_list_roles,
+        pycypher_ast_list_props, pycypher_ast_list_prop_t, role) ||
+      INTERN_NAMES(pycypher_ast_list_plus_one_roles,
+        pycypher_ast_list_plus_one_props, pycypher_ast_list_plus_one_prop_t, role) ||
+      INTERN_NAMES(pycypher_operator_names,
+        pycypher_operators, pycypher_operator_t, name))
+    return -1;
+  return 0;
+}
+
+#undef INTERN_NAMES
+
+PyObject* pycypher_prop_ref_name_object(const pycypher_prop_ref_t* ref) {
+  return pycypher_prop_names[ref->kind][ref->index];
+}
+
+PyObject* pycypher_prop_ref_role(const pycypher_prop_ref_t* ref) {
+  switch(ref->kind) {
+    case PYCYPHER_AST_LIST_PROP:
+      return pycypher_ast_list_roles[ref->index];
+    case PYCYPHER_AST_LIST_PLUS_ONE_PROP:
+      return pycypher_ast_list_plus_one_roles[ref->index];
+    default:
+      return pycypher_prop_names[ref->kind][ref->index];
+  }
+}
+
+const char* pycypher_operator_name(const cypher_operator_t* op) {
   unsigned int i;
   for(i=0; i<pycypher_operators_len; ++i)
     if(op == pycypher_operators[i].operator)
-      return Py_BuildValue("s", pycypher_operators[i].name);
-  return Py_BuildValue("s", "CYPHER_OP_UNKNOWN");
+      return pycypher_operators[i].name;
+  return "CYPHER_OP_UNKNOWN";
 }
 
-PyObject* pycypher_astnode_to_python_dict(const cypher_astnode_t* src_ast, const char* role) {
-  PyObject* result = PyDict_New();
-  PyDict_SetItemString(result, "id", Py_BuildValue("i", src_ast));
-  PyDict_SetItemString(result, "role", Py_BuildValue("s", role));
-  return result;
+const char* pycypher_direction_name(enum cypher_rel_direction direction) {
+  if(direction == CYPHER_REL_INBOUND)
+    return "CYPHER_REL_INBOUND";
+  if(direction == CYPHER_REL_OUTBOUND)
+    return "CYPHER_REL_OUTBOUND";
+  if(direction == CYPHER_REL_BIDIRECTIONAL)
+    return "CYPHER_REL_BIDIRECTIONAL";
+  return "CYPHER_REL_UNKNOWN";
 }
 
-PyObject* pycypher_extract_direction_prop(const cypher_astnode_t* src_ast, pycypher_direction_prop_t* prop) {
-  enum cypher_rel_direction src_prop = prop->getter(src_ast);
-  if(src_prop == CYPHER_REL_INBOUND)
-    return Py_BuildValue("s", "CYPHER_REL_INBOUND");
-  if(src_prop == CYPHER_REL_OUTBOUND)
-    return Py_BuildValue("s", "CYPHER_REL_OUTBOUND");
-  if(src_prop == CYPHER_REL_BIDIRECTIONAL)
-    return Py_BuildValue("s", "CYPHER_REL_BIDIRECTIONAL");
-  return Py_BuildValue("s", "CYPHER_REL_UNKNOWN");
+PyObject* pycypher_operator_to_python_string(const cypher_operator_t* op) {
+  unsigned int i;
+  for(i=0; i<pycypher_operators_len; ++i)
+    if(op == pycypher_operators[i].operator) {
+      Py_INCREF(pycypher_operator_names[i]);
+      return pycypher_operator_names[i];
+    }
+  return Py_BuildValue("s", pycypher_operator_name(op));
+}
+
+PyObject* pycypher_astnode_to_python_dict(
+  const cypher_astnode_t* src_ast, const char* role,
+  const pycypher_ptr_map_t* ordinals
+) {
+  size_t ordinal;
+  if(!pycypher_ptr_map_get(ordinals, src_ast, &ordinal)) {
+    PyErr_SetString(PyExc_ValueError, "AST prop refers to a node outside of its tree");
+    return NULL;
+  }
+  return pycypher_stats_allocated(
+    Py_BuildValue("{s:n,s:s}", "id", (Py_ssize_t)ordinal, "role", role)
+  );
+}
+
+PyObject* pycypher_extract_direction_prop(const cypher_astnode_t* src_ast, const pycypher_direction_prop_t* prop) {
+  return Py_BuildValue("s", pycypher_direction_name(prop->getter(src_ast)));
 }
 
-PyObject* pycypher_extract_operator_prop(const cypher_astnode_t* src_ast, pycypher_operator_prop_t* prop) {
+PyObject* pycypher_extract_operator_prop(const cypher_astnode_t* src_ast, const pycypher_operator_prop_t* prop) {
   const cypher_operator_t* src_prop = prop->getter(src_ast);
   return pycypher_operator_to_python_string(src_prop);
 }
 
-PyObject* pycypher_extract_operator_list_prop(const cypher_astnode_t* src_ast, pycypher_operator_list_prop_t* prop) {
+PyObject* pycypher_extract_operator_list_prop(const cypher_astnode_t* src_ast, const pycypher_operator_list_prop_t* prop) {
   unsigned int n = prop->length_getter(src_ast);
-  PyObject* result = PyList_New(n);
+  PyObject* result = pycypher_stats_allocated(PyList_New(n));
   unsigned int i;
   for(i=0; i<n; ++i)
     // PyList_SetItem consumes a reference so no need to call Py_DECREF
@@ -57,7 +164,7 @@ PyObject* pycypher_extract_operator_list_prop(const cypher_astnode_t* src_ast, p
   return result;
 }
 
-PyObject* pycypher_extract_bool_prop(const cypher_astnode_t* src_ast, pycypher_bool_prop_t* prop) {
+PyObject* pycypher_extract_bool_prop(const cypher_astnode_t* src_ast, const pycypher_bool_prop_t* prop) {
   bool src_prop = prop->getter(src_ast);
   if(src_prop)
     Py_RETURN_TRUE;
@@ -65,133 +172,225 @@ PyObject* pycypher_extract_bool_prop(const cypher_astnode_t* src_ast, pycypher_b
     Py_RETURN_FALSE;
 }
 
-PyObject* pycypher_extract_string_prop(const cypher_astnode_t* src_ast, pycypher_string_prop_t* prop) {
+PyObject* pycypher_extract_string_prop(const cypher_astnode_t* src_ast, const pycypher_string_prop_t* prop) {
   const char* src_prop = prop->getter(src_ast);
   return Py_BuildValue("s", src_prop);
 }
 
-PyObject* pycypher_extract_ast_list_prop(const cypher_astnode_t* src_ast, pycypher_ast_list_prop_t* prop) {
-  unsigned int n = prop->length_getter(src_ast);
-  PyObject* result = PyList_New(n);
+static PyObject* pycypher_astnode_list_to_python(
+  const cypher_astnode_t* src_ast, pycypher_ast_list_getter_t list_getter,
+  unsigned int n, const char* role, const pycypher_ptr_map_t* ordinals
+) {
+  PyObject* result = pycypher_stats_allocated(PyList_New(n));
   unsigned int i;
-  for(i=0; i<n; ++i)
-    // PyList_SetItem consumes a reference so no need to call Py_DECREF
-    PyList_SetItem(result, i, pycypher_astnode_to_python_dict(
-      prop->list_getter(src_ast, i), prop->role
-    ));
+  for(i=0; result != NULL && i<n; ++i) {
+    PyObject* ref = pycypher_astnode_to_python_dict(
+      list_getter(src_ast, i), role, ordinals
+    );
+    if(ref == NULL)
+      Py_CLEAR(result);
+    else
+      PyList_SET_ITEM(result, i, ref);
+  }
   return result;
 }
 
-PyObject* pycypher_extract_ast_list_plus_one_prop(const cypher_astnode_t* src_ast, pycypher_ast_list_plus_one_prop_t* prop) {
-  unsigned int n = prop->length_getter(src_ast) + 1;
-  PyObject* result = PyList_New(n);
-  unsigned int i;
-  for(i=0; i<n; ++i)
-    // PyList_SetItem consumes a reference so no need to call Py_DECREF
-    PyList_SetItem(result, i, pycypher_astnode_to_python_dict(
-      prop->list_getter(src_ast, i), prop->role
-    ));
-  return result;
+PyObject* pycypher_extract_ast_list_prop(
+  const cypher_astnode_t* src_ast, const pycypher_ast_list_prop_t* prop,
+  const pycypher_ptr_map_t* ordinals
+) {
+  return pycypher_astnode_list_to_python(
+    src_ast, prop->list_getter, prop->length_getter(src_ast), prop->role,
+    ordinals
+  );
+}
+
+PyObject* pycypher_extract_ast_list_plus_one_prop(
+  const cypher_astnode_t* src_ast, const pycypher_ast_list_plus_one_prop_t* prop,
+  const pycypher_ptr_map_t* ordinals
+) {
+  return pycypher_astnode_list_to_python(
+    src_ast, prop->list_getter, prop->length_getter(src_ast) + 1, prop->role,
+    ordinals
+  );
 }
 
-PyObject* pycypher_extract_ast_prop(const cypher_astnode_t* src_ast, pycypher_ast_prop_t* prop) {
+PyObject* pycypher_extract_ast_prop(
+  const cypher_astnode_t* src_ast, const pycypher_ast_prop_t* prop,
+  const pycypher_ptr_map_t* ordinals
+) {
   const cypher_astnode_t* src_prop = prop->getter(src_ast);
   if(!src_prop)
     Py_RETURN_NONE;
-  return pycypher_astnode_to_python_dict(src_prop, prop->name);
+  return pycypher_astnode_to_python_dict(src_prop, prop->name, ordinals);
 }
 
-PyObject* pycypher_extract_props(const cypher_astnode_t* src_ast) {
-  PyObject* result = PyDict_New();
-  PyObject* extracted_prop;
-  unsigned int i;
-  for(i=0; i<pycypher_direction_props_len; ++i)
-    if(cypher_astnode_instanceof(src_ast, pycypher_direction_props[i].node_type)) {
-      extracted_prop = pycypher_extract_direction_prop(
-        src_ast, &pycypher_direction_props[i]
-      );
-      if(extracted_prop != Py_None)
-        PyDict_SetItemString(
-          result, pycypher_direction_props[i].name, extracted_prop
-        );
-      Py_DECREF(extracted_prop);
-    }
-  for(i=0; i<pycypher_operator_props_len; ++i)
-    if(cypher_astnode_instanceof(src_ast, pycypher_operator_props[i].node_type)) {
-      extracted_prop = pycypher_extract_operator_prop(
-        src_ast, &pycypher_operator_props[i]
-      );
-      if(extracted_prop != Py_None)
-        PyDict_SetItemString(
-          result, pycypher_operator_props[i].name, extracted_prop
-        );
-      Py_DECREF(extracted_prop);
-    }
-  for(i=0; i<pycypher_operator_list_props_len; ++i)
-    if(cypher_astnode_instanceof(src_ast, pycypher_operator_list_props[i].node_type)) {
-      extracted_prop = pycypher_extract_operator_list_prop(
-        src_ast, &pycypher_operator_list_props[i]
-      );
-      if(extracted_prop != Py_None)
-        PyDict_SetItemString(
-          result, pycypher_operator_list_props[i].name, extracted_prop
-        );
-      Py_DECREF(extracted_prop);
-    }
-  for(i=0; i<pycypher_bool_props_len; ++i)
-    if(cypher_astnode_instanceof(src_ast, pycypher_bool_props[i].node_type)) {
-      extracted_prop = pycypher_extract_bool_prop(
-        src_ast, &pycypher_bool_props[i]
-      );
-      if(extracted_prop != Py_None)
-        PyDict_SetItemString(
-          result, pycypher_bool_props[i].name, extracted_prop
-        );
-      Py_DECREF(extracted_prop);
+/* Props which apply to a node depend only on its type, so the tables are
+scanned (honouring the instanceof hierarchy) once per node type, the first time
+a node of that type is seen. Later nodes of the same type only visit their own
+props. Plans are built under a lock, as the native parts of the bindings
+(fingerprints, matchers) may run on threads without the GIL.
+*/
+static pycypher_prop_plan_t pycypher_prop_plans[PYCYPHER_NODE_TYPES_CAPACITY];
+static pthread_mutex_t pycypher_prop_plans_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#define PLAN_PROPS(prop_kind, table) \
+  for(i=0; i<table##_len; ++i) \
+    if(cypher_astnode_instanceof(src_ast, table[i].node_type)) { \
+      if(refs != NULL) { \
+        refs[len].kind = prop_kind; \
+        refs[len].prop = &table[i]; \
+        refs[len].index = i; \
+      } \
+      ++len; \
     }
-  for(i=0; i<pycypher_string_props_len; ++i)
-    if(cypher_astnode_instanceof(src_ast, pycypher_string_props[i].node_type)) {
-      extracted_prop = pycypher_extract_string_prop(
-        src_ast, &pycypher_string_props[i]
-      );
-      if(extracted_prop != Py_None)
-        PyDict_SetItemString(
-          result, pycypher_string_props[i].name, extracted_prop
-        );
-      Py_DECREF(extracted_prop);
+
+static size_t pycypher_plan_props(
+  const cypher_astnode_t* src_ast, pycypher_prop_ref_t* refs
+) {
+  size_t len = 0;
+  size_t i;
+  PLAN_PROPS(PYCYPHER_DIRECTION_PROP, pycypher_direction_props)
+  PLAN_PROPS(PYCYPHER_OPERATOR_PROP, pycypher_operator_props)
+  PLAN_PROPS(PYCYPHER_OPERATOR_LIST_PROP, pycypher_operator_list_props)
+  PLAN_PROPS(PYCYPHER_BOOL_PROP, pycypher_bool_props)
+  PLAN_PROPS(PYCYPHER_STRING_PROP, pycypher_string_props)
+  PLAN_PROPS(PYCYPHER_AST_LIST_PROP, pycypher_ast_list_props)
+  PLAN_PROPS(PYCYPHER_AST_LIST_PLUS_ONE_PROP, pycypher_ast_list_plus_one_props)
+  PLAN_PROPS(PYCYPHER_AST_PROP, pycypher_ast_props)
+  return len;
+}
+
+#undef PLAN_PROPS
+
+const char* pycypher_prop_ref_name(const pycypher_prop_ref_t* ref) {
+  switch(ref->kind) {
+    case PYCYPHER_DIRECTION_PROP:
+      return ((const pycypher_direction_prop_t*)ref->prop)->name;
+    case PYCYPHER_OPERATOR_PROP:
+      return ((const pycypher_operator_prop_t*)ref->prop)->name;
+    case PYCYPHER_OPERATOR_LIST_PROP:
+      return ((const pycypher_operator_list_prop_t*)ref->prop)->name;
+    case PYCYPHER_BOOL_PROP:
+      return ((const pycypher_bool_prop_t*)ref->prop)->name;
+    case PYCYPHER_STRING_PROP:
+      return ((const pycypher_string_prop_t*)ref->prop)->name;
+    case PYCYPHER_AST_LIST_PROP:
+      return ((const pycypher_ast_list_prop_t*)ref->prop)->name;
+    case PYCYPHER_AST_LIST_PLUS_ONE_PROP:
+      return ((const pycypher_ast_list_plus_one_prop_t*)ref->prop)->name;
+    case PYCYPHER_AST_PROP:
+      return ((const pycypher_ast_prop_t*)ref->prop)->name;
+  }
+  return NULL;
+}
+
+const pycypher_prop_plan_t* pycypher_get_prop_plan(const cypher_astnode_t* src_ast) {
+  pycypher_prop_plan_t* plan = &pycypher_prop_plans[cypher_astnode_type(src_ast)];
+  if(__atomic_load_n(&plan->ready, __ATOMIC_ACQUIRE))
+    return plan;
+  pthread_mutex_lock(&pycypher_prop_plans_lock);
+  if(!plan->ready) {
+    size_t len = pycypher_plan_props(src_ast, NULL);
+    pycypher_prop_ref_t* refs = NULL;
+    if(len > 0) {
+      refs = malloc(len * sizeof(pycypher_prop_ref_t));
+      if(refs == NULL) {
+        pthread_mutex_unlock(&pycypher_prop_plans_lock);
+        return NULL;
+      }
+      pycypher_plan_props(src_ast, refs);
     }
-  for(i=0; i<pycypher_ast_list_props_len; ++i)
-    if(cypher_astnode_instanceof(src_ast, pycypher_ast_list_props[i].node_type)) {
-      extracted_prop = pycypher_extract_ast_list_prop(
-        src_ast, &pycypher_ast_list_props[i]
-      );
-      if(extracted_prop != Py_None)
-        PyDict_SetItemString(
-          result, pycypher_ast_list_props[i].name, extracted_prop
-        );
-      Py_DECREF(extracted_prop);
+    plan->refs = refs;
+    plan->len = len;
+    __atomic_store_n(&plan->ready, true, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&pycypher_prop_plans_lock);
+  return plan;
+}
+
+PyObject* pycypher_extract_prop(
+  const cypher_astnode_t* src_ast, const pycypher_prop_ref_t* ref,
+  const pycypher_ptr_map_t* ordinals
+) {
+  switch(ref->kind) {
+    case PYCYPHER_DIRECTION_PROP:
+      return pycypher_extract_direction_prop(src_ast, ref->prop);
+    case PYCYPHER_OPERATOR_PROP:
+      return pycypher_extract_operator_prop(src_ast, ref->prop);
+    case PYCYPHER_OPERATOR_LIST_PROP:
+      return pycypher_extract_operator_list_prop(src_ast, ref->prop);
+    case PYCYPHER_BOOL_PROP:
+      return pycypher_extract_bool_prop(src_ast, ref->prop);
+    case PYCYPHER_STRING_PROP:
+      return pycypher_extract_string_prop(src_ast, ref->prop);
+    case PYCYPHER_AST_LIST_PROP:
+      return pycypher_extract_ast_list_prop(src_ast, ref->prop, ordinals);
+    case PYCYPHER_AST_LIST_PLUS_ONE_PROP:
+      return pycypher_extract_ast_list_plus_one_prop(src_ast, ref->prop, ordinals);
+    case PYCYPHER_AST_PROP:
+      return pycypher_extract_ast_prop(src_ast, ref->prop, ordinals);
+  }
+  Py_RETURN_NONE;
+}
+
+PyObject* pycypher_extract_props(
+  const cypher_astnode_t* src_ast, const pycypher_ptr_map_t* ordinals
+) {
+  const pycypher_prop_plan_t* plan = pycypher_get_prop_plan(src_ast);
+  if(plan == NULL)
+    return PyErr_NoMemory();
+  PyObject* result = pycypher_stats_allocated(PyDict_New());
+  PyObject* extracted_prop;
+  size_t i;
+  for(i=0; i<plan->len; ++i) {
+    extracted_prop = pycypher_extract_prop(src_ast, &plan->refs[i], ordinals);
+    if(extracted_prop == NULL) {
+      Py_DECREF(result);
+      return NULL;
     }
-  for(i=0; i<pycypher_ast_list_plus_one_props_len; ++i)
-    if(cypher_astnode_instanceof(src_ast, pycypher_ast_list_plus_one_props[i].node_type)) {
-      extracted_prop = pycypher_extract_ast_list_plus_one_prop(
-        src_ast, &pycypher_ast_list_plus_one_props[i]
+    if(extracted_prop != Py_None)
+      PyDict_SetItem(
+        result, pycypher_prop_ref_name_object(&plan->refs[i]), extracted_prop
       );
-      if(extracted_prop != Py_None)
-        PyDict_SetItemString(
-          result, pycypher_ast_list_plus_one_props[i].name, extracted_prop
-        );
-      Py_DECREF(extracted_prop);
+    Py_DECREF(extracted_prop);
+  }
+  return result;
+}
+
+int pycypher_extract_value_props(const cypher_astnode_t* src_ast, PyObject** result) {
+  *result = NULL;
+  const pycypher_prop_plan_t* plan = pycypher_get_prop_plan(src_ast);
+  if(plan == NULL) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  size_t i;
+  for(i=0; i<plan->len; ++i) {
+    if(pycypher_is_ast_prop(&plan->refs[i]))
+      continue;
+    PyObject* value = pycypher_extract_prop(src_ast, &plan->refs[i], NULL);
+    if(value == NULL)
+      goto error;
+    if(value == Py_None || (PyList_Check(value) && PyList_GET_SIZE(value) == 0)) {
+      Py_DECREF(value);
+      continue;
     }
-  for(i=0; i<pycypher_ast_props_len; ++i)
-    if(cypher_astnode_instanceof(src_ast, pycypher_ast_props[i].node_type)) {
-      extracted_prop = pycypher_extract_ast_prop(
-        src_ast, &pycypher_ast_props[i]
-      );
-      if(extracted_prop != Py_None)
-        PyDict_SetItemString(
-          result, pycypher_ast_props[i].name, extracted_prop
-        );
-      Py_DECREF(extracted_prop);
+    if(*result == NULL &&
+        (*result = pycypher_stats_allocated(PyDict_New())) == NULL) {
+      Py_DECREF(value);
+      goto error;
     }
-  return result;
+    int error = PyDict_SetItem(
+      *result, pycypher_prop_ref_name_object(&plan->refs[i]), value
+    );
+    Py_DECREF(value);
+    if(error < 0)
+      goto error;
+  }
+  return 0;
+
+error:
+  Py_CLEAR(*result);
+  return -1;
 }
@@ -18,6 +18,71 @@
 #include <cypher-parser.h>
 #include "props.h"
 #include "operators.h"
+#include "node_types.h"
+#include "ptr_map.h"
+
+typedef enum {
+  PYCYPHER_DIRECTION_PROP,
+  PYCYPHER_OPERATOR_PROP,
+  PYCYPHER_OPERATOR_LIST_PROP,
+  PYCYPHER_BOOL_PROP,
+  PYCYPHER_STRING_PROP,
+  PYCYPHER_AST_LIST_PROP,
+  PYCYPHER_AST_LIST_PLUS_ONE_PROP,
+  PYCYPHER_AST_PROP
+}
+pycypher_prop_kind_t;
+
+/* A reference to one entry of the prop table of the given kind, e.g. for
+PYCYPHER_BOOL_PROP prop points into pycypher_bool_props, at the given index.
+*/
+typedef struct {
+  pycypher_prop_kind_t kind;
+  const void* prop;
+  size_t index;
+}
+pycypher_prop_ref_t;
+
+/* All props applicable to nodes of a single type, in the order in which they
+are put into the dict returned by pycypher_extract_props.
+*/
+typedef struct {
+  bool ready;
+  size_t len;
+  pycypher_prop_ref_t* refs;
+}
+pycypher_prop_plan_t;
+
+/* Return the plan for the type of the given node or NULL when out of memory.
+*/
+const pycypher_prop_plan_t* pycypher_get_prop_plan(const cypher_astnode_t*);
+const char* pycypher_prop_ref_name(const pycypher_prop_ref_t*);
+
+/* Intern the names of all props, the roles of AST props and the names of
+operators. Has to be called after pycypher_init_props and
+pycypher_init_operators. Return -1 with an exception set on failure.
+*/
+int pycypher_init_prop_names(void);
+
+/* Both functions return borrowed references to interned strings. The role of
+an AST prop is the role its children get, which for single AST props is the
+name of the prop.
+*/
+PyObject* pycypher_prop_ref_name_object(const pycypher_prop_ref_t*);
+PyObject* pycypher_prop_ref_role(const pycypher_prop_ref_t*);
+
+static inline bool pycypher_is_ast_prop(const pycypher_prop_ref_t* ref) {
+  return ref->kind == PYCYPHER_AST_LIST_PROP ||
+    ref->kind == PYCYPHER_AST_LIST_PLUS_ONE_PROP ||
+    ref->kind == PYCYPHER_AST_PROP;
+}
+/* ordinals maps the nodes AST props refer to to their ids, see
+pycypher_put_ordinals, and may be NULL for other props.
+*/
+PyObject* pycypher_extract_prop(
+  const cypher_astnode_t*, const pycypher_prop_ref_t*,
+  const pycypher_ptr_map_t* ordinals
+);
 
 /* Return a dict where keys are names of props (as defined in props.c) and
 values are:
@@ -27,11 +92,25 @@ values are:
  - strings 'CYPHER_REL_INBOUND', 'CYPHER_REL_OUTBOUND' or 'CYPHER_REL_BIDIRECTIONAL' for direction properties
  - strings 'CYPHER_OP_OR','CYPHER_OP_MAP_PROJECTION', etc. for operator properties
  - dictionaries {"id": id, "role": role} where
-   id is an integer identifying an AST node and role is a singular
+   id is the ordinal of an AST node in ordinals and role is a singular
    form of the prop name, for example:
    {..., "clauses": [{"id": 3, "role": "clause"}, {"id": 5, "role": "clause"}], ...}
    {..., "where": {"id": 4, "role": "where"}, ...}
 */
-PyObject* pycypher_extract_props(const cypher_astnode_t*);
+PyObject* pycypher_extract_props(
+  const cypher_astnode_t*, const pycypher_ptr_map_t* ordinals
+);
+
+/* Store into *result a dict of the props of the node other than AST props,
+leaving out empty lists like CypherAstNode does, or NULL if there are none.
+Return -1 with an exception set on failure.
+*/
+int pycypher_extract_value_props(const cypher_astnode_t*, PyObject** result);
+
+/* Names used for operator and direction props, e.g. 'CYPHER_OP_OR' or
+'CYPHER_REL_INBOUND'.
+*/
+const char* pycypher_operator_name(const cypher_operator_t*);
+const char* pycypher_direction_name(enum cypher_rel_direction);
 
 #endif
@@ -0,0 +1,223 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "fingerprint.h"
+#include "parser.h"
+
+#define PYCYPHER_FNV_OFFSET_BASIS 14695981039346656037ULL
+#define PYCYPHER_FNV_PRIME 1099511628211ULL
+
+static uint64_t pycypher_hash_bytes(uint64_t hash, const void* data, size_t len) {
+  const unsigned char* bytes = data;
+  size_t i;
+  for(i=0; i<len; ++i) {
+    hash ^= bytes[i];
+    hash *= PYCYPHER_FNV_PRIME;
+  }
+  return hash;
+}
+
+static uint64_t pycypher_hash_uint(uint64_t hash, uint64_t value) {
+  return pycypher_hash_bytes(hash, &value, sizeof(value));
+}
+
+static uint64_t pycypher_hash_string(uint64_t hash, const char* s) {
+  if(s == NULL)
+    return pycypher_hash_uint(hash, 0);
+  size_t len = strlen(s);
+  // The length goes first so that adjacent strings can't be confused.
+  hash = pycypher_hash_uint(hash, len + 1);
+  return pycypher_hash_bytes(hash, s, len);
+}
+
+/* An unaliased projection gets an alias identifier named after the source
+text of its expression, which may be a literal.
+*/
+static bool pycypher_is_implicit_alias(
+  const cypher_astnode_t* parent, const cypher_astnode_t* src_ast
+) {
+  if(parent == NULL || cypher_astnode_type(parent) != CYPHER_AST_PROJECTION ||
+      cypher_ast_projection_get_alias(parent) != src_ast)
+    return false;
+  struct cypher_input_range alias = cypher_astnode_range(src_ast);
+  struct cypher_input_range expression = cypher_astnode_range(
+    cypher_ast_projection_get_expression(parent)
+  );
+  return alias.start.offset == expression.start.offset &&
+    alias.end.offset == expression.end.offset;
+}
+
+static bool pycypher_is_placeholder(
+  const cypher_astnode_t* parent, const cypher_astnode_t* src_ast
+) {
+  cypher_astnode_type_t type = cypher_astnode_type(src_ast);
+  return pycypher_is_implicit_alias(parent, src_ast) ||
+    type == CYPHER_AST_INTEGER ||
+    type == CYPHER_AST_FLOAT ||
+    type == CYPHER_AST_STRING ||
+    type == CYPHER_AST_TRUE ||
+    type == CYPHER_AST_FALSE ||
+    type == CYPHER_AST_NULL ||
+    type == CYPHER_AST_PARAMETER;
+}
+
+/* Hash the position among the children of src_ast of a node an AST prop
+refers to, so that the same children filling different props (e.g. the skip
+and limit of a projection) don't hash the same. Nodes which aren't children
+hash as one past the last child, missing ones as two past.
+*/
+static uint64_t pycypher_hash_child_ref(
+  uint64_t hash, const cypher_astnode_t* src_ast, Py_ssize_t nchildren,
+  const cypher_astnode_t* target, Py_ssize_t* cursor
+) {
+  Py_ssize_t i = target == NULL
+    ? nchildren + 1
+    : pycypher_find_child(src_ast, nchildren, target, cursor);
+  return pycypher_hash_uint(hash, i < 0 ? nchildren : i);
+}
+
+static uint64_t pycypher_hash_prop(
+  uint64_t hash, const cypher_astnode_t* src_ast, const pycypher_prop_ref_t* ref,
+  size_t index, Py_ssize_t* cursor
+) {
+  Py_ssize_t nchildren = cypher_astnode_nchildren(src_ast);
+  unsigned int n;
+  unsigned int i;
+  switch(ref->kind) {
+    case PYCYPHER_DIRECTION_PROP: {
+      const pycypher_direction_prop_t* prop = ref->prop;
+      return pycypher_hash_uint(hash, prop->getter(src_ast));
+    }
+    case PYCYPHER_OPERATOR_PROP: {
+      const pycypher_operator_prop_t* prop = ref->prop;
+      return pycypher_hash_string(
+        hash, pycypher_operator_name(prop->getter(src_ast))
+      );
+    }
+    case PYCYPHER_OPERATOR_LIST_PROP: {
+      const pycypher_operator_list_prop_t* prop = ref->prop;
+      n = prop->length_getter(src_ast);
+      hash = pycypher_hash_uint(hash, n);
+      for(i=0; i<n; ++i)
+        hash = pycypher_hash_string(
+          hash, pycypher_operator_name(prop->list_getter(src_ast, i))
+        );
+      return hash;
+    }
+    case PYCYPHER_BOOL_PROP: {
+      const pycypher_bool_prop_t* prop = ref->prop;
+      return pycypher_hash_uint(hash, prop->getter(src_ast) ? 1 : 0);
+    }
+    case PYCYPHER_STRING_PROP: {
+      const pycypher_string_prop_t* prop = ref->prop;
+      return pycypher_hash_string(hash, prop->getter(src_ast));
+    }
+    // AST props point at children, which are hashed by the tree walk; only
+    // which prop they fill is hashed here.
+    case PYCYPHER_AST_PROP: {
+      const pycypher_ast_prop_t* prop = ref->prop;
+      hash = pycypher_hash_uint(hash, index);
+      return pycypher_hash_child_ref(
+        hash, src_ast, nchildren, prop->getter(src_ast), cursor
+      );
+    }
+    case PYCYPHER_AST_LIST_PROP: {
+      const pycypher_ast_list_prop_t* prop = ref->prop;
+      n = prop->length_getter(src_ast);
+      hash = pycypher_hash_uint(pycypher_hash_uint(hash, index), n);
+      for(i=0; i<n; ++i)
+        hash = pycypher_hash_child_ref(
+          hash, src_ast, nchildren, prop->list_getter(src_ast, i), cursor
+        );
+      return hash;
+    }
+    case PYCYPHER_AST_LIST_PLUS_ONE_PROP: {
+      const pycypher_ast_list_plus_one_prop_t* prop = ref->prop;
+      n = prop->length_getter(src_ast) + 1;
+      hash = pycypher_hash_uint(pycypher_hash_uint(hash, index), n);
+      for(i=0; i<n; ++i)
+        hash = pycypher_hash_child_ref(
+          hash, src_ast, nchildren, prop->list_getter(src_ast, i), cursor
+        );
+      return hash;
+    }
+  }
+  return hash;
+}
+
+static int pycypher_fingerprint_node(
+  const cypher_astnode_t* parent, const cypher_astnode_t* src_ast,
+  uint64_t* hash
+) {
+  if(pycypher_is_placeholder(parent, src_ast)) {
+    *hash = pycypher_hash_string(*hash, "?");
+    return 0;
+  }
+  const pycypher_prop_plan_t* plan = pycypher_get_prop_plan(src_ast);
+  if(plan == NULL)
+    return -1;
+  unsigned int nchildren = cypher_astnode_nchildren(src_ast);
+  Py_ssize_t cursor = 0;
+  size_t i;
+  *hash = pycypher_hash_uint(*hash, cypher_astnode_type(src_ast));
+  for(i=0; i<plan->len; ++i)
+    *hash = pycypher_hash_prop(*hash, src_ast, &plan->refs[i], i, &cursor);
+  *hash = pycypher_hash_uint(*hash, nchildren);
+  for(i=0; i<nchildren; ++i)
+    if(pycypher_fingerprint_node(
+        src_ast, cypher_astnode_get_child(src_ast, i), hash
+    ) < 0)
+      return -1;
+  return 0;
+}
+
+int pycypher_fingerprint(const cypher_parse_result_t* parse_result, uint64_t* result) {
+  unsigned int nroots = cypher_parse_result_nroots(parse_result);
+  uint64_t hash = PYCYPHER_FNV_OFFSET_BASIS;
+  unsigned int i;
+  for(i=0; i<nroots; ++i)
+    if(pycypher_fingerprint_node(
+        NULL, cypher_parse_result_get_root(parse_result, i), &hash
+    ) < 0)
+      return -1;
+  *result = hash;
+  return 0;
+}
+
+PyObject* pycypher_fingerprint_query(PyObject* self, PyObject* args) {
+  char* query;
+  if (!PyArg_ParseTuple(args, "s:fingerprint_query", &query))
+    return NULL;
+  const pycypher_parser_options_t* options = pycypher_parser_options(self);
+  cypher_parse_result_t* parse_result;
+  uint64_t fingerprint;
+  int error = 0;
+  Py_BEGIN_ALLOW_THREADS
+  parse_result = pycypher_invoke_parser(options, query, strlen(query));
+  if(parse_result != NULL)
+    error = pycypher_fingerprint(parse_result, &fingerprint);
+  Py_END_ALLOW_THREADS
+  if(parse_result == NULL)
+    return PyErr_SetFromErrno(PyExc_OSError);
+  PyObject* result = NULL;
+  if(error < 0)
+    PyErr_NoMemory();
+  else
+    result = Py_BuildValue(
+      "(KI)", (unsigned long long)fingerprint,
+      cypher_parse_result_nerrors(parse_result)
+    );
+  cypher_parse_result_free(parse_result);
+  return result;
+}
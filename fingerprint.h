@@ -0,0 +1,32 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_FINGERPRINT_H
+#define PYCYPHER_FINGERPRINT_H
+#include <stdint.h>
+#include <Python.h>
+#include <cypher-parser.h>
+
+/* Return a 64-bit hash of the shape of the tree: node types, tree structure
+and all non-AST props, except that every literal, parameter and implicit
+projection alias contributes only a placeholder. Queries differing only in literal values or parameter
+names therefore have the same fingerprint. Fingerprints are only comparable
+between processes using the same libcypher-parser build, as node types are
+hashed by their numeric value. Doesn't need the GIL.
+*/
+int pycypher_fingerprint(const cypher_parse_result_t*, uint64_t* result);
+
+PyObject* pycypher_fingerprint_query(PyObject*, PyObject*);
+
+#endif
@@ -0,0 +1,217 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "flat.h"
+#include "parser.h"
+
+typedef struct {
+  unsigned char* types;
+  int* parents;
+  unsigned int* child_offsets;
+  unsigned int* children;
+  unsigned long long* starts;
+  unsigned long long* ends;
+  unsigned int* string_offsets;
+  char* strings;
+  unsigned int nnodes;
+  unsigned int nchildren;
+  unsigned int nstrings;
+}
+pycypher_flat_ast_t;
+
+/* Return the first string prop of the node or NULL if it has none. */
+static const char* pycypher_flat_string(const cypher_astnode_t* src_ast) {
+  const pycypher_prop_plan_t* plan = pycypher_get_prop_plan(src_ast);
+  size_t i;
+  if(plan == NULL)
+    return NULL;
+  for(i=0; i<plan->len; ++i)
+    if(plan->refs[i].kind == PYCYPHER_STRING_PROP)
+      return ((const pycypher_string_prop_t*)plan->refs[i].prop)->getter(src_ast);
+  return NULL;
+}
+
+/* Count nodes, children and string bytes of the subtree. */
+static void pycypher_measure_flat_ast(
+  pycypher_flat_ast_t* flat, const cypher_astnode_t* src_ast
+) {
+  unsigned int nchildren = cypher_astnode_nchildren(src_ast);
+  const char* string = pycypher_flat_string(src_ast);
+  unsigned int i;
+  ++flat->nnodes;
+  flat->nchildren += nchildren;
+  if(string != NULL)
+    flat->nstrings += strlen(string);
+  for(i=0; i<nchildren; ++i)
+    pycypher_measure_flat_ast(flat, cypher_astnode_get_child(src_ast, i));
+}
+
+/* Store the subtree in pre-order, return the index of its root. */
+static unsigned int pycypher_fill_flat_ast(
+  pycypher_flat_ast_t* flat, const cypher_astnode_t* src_ast, int parent
+) {
+  unsigned int index = flat->nnodes++;
+  unsigned int nchildren = cypher_astnode_nchildren(src_ast);
+  struct cypher_input_range range = cypher_astnode_range(src_ast);
+  const char* string = pycypher_flat_string(src_ast);
+  unsigned int first_child;
+  unsigned int i;
+
+  flat->types[index] = cypher_astnode_type(src_ast);
+  flat->parents[index] = parent;
+  flat->starts[index] = range.start.offset;
+  flat->ends[index] = range.end.offset;
+  flat->string_offsets[index] = flat->nstrings;
+  if(string != NULL) {
+    size_t length = strlen(string);
+    memcpy(flat->strings + flat->nstrings, string, length);
+    flat->nstrings += length;
+  }
+  // Children get consecutive slots, reserved before descending so that
+  // child_offsets stays sorted.
+  first_child = flat->nchildren;
+  flat->child_offsets[index] = first_child;
+  flat->nchildren += nchildren;
+  for(i=0; i<nchildren; ++i)
+    flat->children[first_child + i] = pycypher_fill_flat_ast(
+      flat, cypher_astnode_get_child(src_ast, i), index
+    );
+  return index;
+}
+
+static PyObject* pycypher_flat_type_names(void) {
+  int ntypes = 0;
+  size_t i;
+  for(i=0; i<pycypher_node_types_len; ++i)
+    if(pycypher_node_types[i].node_type >= ntypes)
+      ntypes = pycypher_node_types[i].node_type + 1;
+  PyObject* result = PyTuple_New(ntypes);
+  if(result == NULL)
+    return NULL;
+  int j;
+  for(j=0; j<ntypes; ++j) {
+    Py_INCREF(Py_None);
+    PyTuple_SET_ITEM(result, j, Py_None);
+  }
+  for(i=0; i<pycypher_node_types_len; ++i) {
+    PyObject* name = Py_BuildValue("s", pycypher_node_types[i].name);
+    if(name == NULL) {
+      Py_DECREF(result);
+      return NULL;
+    }
+    j = pycypher_node_types[i].node_type;
+    Py_DECREF(PyTuple_GET_ITEM(result, j));
+    PyTuple_SET_ITEM(result, j, name);
+  }
+  return result;
+}
+
+void* pycypher_add_flat_column(
+  PyObject* columns, const char* name, size_t size
+) {
+#if PY_MAJOR_VERSION >= 3
+  PyObject* column = PyBytes_FromStringAndSize(NULL, size);
+#else
+  PyObject* column = PyString_FromStringAndSize(NULL, size);
+#endif
+  if(column == NULL)
+    return NULL;
+  int error = PyDict_SetItemString(columns, name, column);
+  Py_DECREF(column);
+  if(error < 0)
+    return NULL;
+#if PY_MAJOR_VERSION >= 3
+  return PyBytes_AS_STRING(column);
+#else
+  return PyString_AS_STRING(column);
+#endif
+}
+
+PyObject* pycypher_build_flat_ast(const cypher_parse_result_t* parse_result) {
+  pycypher_flat_ast_t flat;
+  unsigned int nroots = cypher_parse_result_nroots(parse_result);
+  unsigned int* roots;
+  unsigned int i;
+
+  memset(&flat, 0, sizeof(flat));
+  for(i=0; i<nroots; ++i)
+    pycypher_measure_flat_ast(&flat, cypher_parse_result_get_root(parse_result, i));
+
+  PyObject* columns = PyDict_New();
+  if(columns == NULL)
+    return NULL;
+  if(
+      (flat.types = pycypher_add_flat_column(
+        columns, "types", flat.nnodes * sizeof(*flat.types))) == NULL ||
+      (flat.parents = pycypher_add_flat_column(
+        columns, "parents", flat.nnodes * sizeof(*flat.parents))) == NULL ||
+      (flat.child_offsets = pycypher_add_flat_column(
+        columns, "child_offsets", (flat.nnodes + 1) * sizeof(*flat.child_offsets))) == NULL ||
+      (flat.children = pycypher_add_flat_column(
+        columns, "children", flat.nchildren * sizeof(*flat.children))) == NULL ||
+      (flat.starts = pycypher_add_flat_column(
+        columns, "starts", flat.nnodes * sizeof(*flat.starts))) == NULL ||
+      (flat.ends = pycypher_add_flat_column(
+        columns, "ends", flat.nnodes * sizeof(*flat.ends))) == NULL ||
+      (flat.string_offsets = pycypher_add_flat_column(
+        columns, "string_offsets", (flat.nnodes + 1) * sizeof(*flat.string_offsets))) == NULL ||
+      (flat.strings = pycypher_add_flat_column(
+        columns, "strings", flat.nstrings)) == NULL ||
+      (roots = pycypher_add_flat_column(
+        columns, "roots", nroots * sizeof(*roots))) == NULL
+  ) {
+    Py_DECREF(columns);
+    return NULL;
+  }
+
+  flat.nnodes = 0;
+  flat.nchildren = 0;
+  flat.nstrings = 0;
+  for(i=0; i<nroots; ++i)
+    roots[i] = pycypher_fill_flat_ast(
+      &flat, cypher_parse_result_get_root(parse_result, i), -1
+    );
+  flat.child_offsets[flat.nnodes] = flat.nchildren;
+  flat.string_offsets[flat.nnodes] = flat.nstrings;
+
+  PyObject* type_names = pycypher_flat_type_names();
+  if(type_names == NULL ||
+      PyDict_SetItemString(columns, "type_names", type_names) < 0) {
+    Py_XDECREF(type_names);
+    Py_DECREF(columns);
+    return NULL;
+  }
+  Py_DECREF(type_names);
+  return columns;
+}
+
+PyObject* pycypher_parse_query_flat(PyObject* self, PyObject* args) {
+  char* query;
+  PyObject* exn_class;
+  if (!PyArg_ParseTuple(args, "Os:parse_flat", &exn_class, &query))
+    return NULL;
+  const pycypher_parser_options_t* options = pycypher_parser_options(self);
+  cypher_parse_result_t* parse_result;
+  Py_BEGIN_ALLOW_THREADS
+  parse_result = pycypher_invoke_parser(options, query, strlen(query));
+  Py_END_ALLOW_THREADS
+  if(parse_result == NULL)
+    return PyErr_SetFromErrno(PyExc_OSError);
+  PyObject* columns = pycypher_build_flat_ast(parse_result);
+  PyObject* exn_list = columns == NULL
+    ? NULL
+    : pycypher_build_exn_list(exn_class, parse_result);
+  cypher_parse_result_free(parse_result);
+  return Py_BuildValue("(NN)", columns, exn_list);
+}
@@ -0,0 +1,46 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_FLAT_H
+#define PYCYPHER_FLAT_H
+#include <Python.h>
+#include <cypher-parser.h>
+
+/* Return a dict of bytes objects holding the parse result as flat arrays
+(struct-of-arrays), one element per node, nodes numbered in pre-order starting
+from the first root:
+ - "types": unsigned char, cypher_astnode_type_t of the node
+ - "parents": int, index of the parent node or -1 for roots
+ - "child_offsets": unsigned int, nnodes + 1 elements, the children of node i
+   are children[child_offsets[i]:child_offsets[i + 1]]
+ - "children": unsigned int, node indices
+ - "starts", "ends": unsigned long long, offsets of the node in the query
+ - "string_offsets": unsigned int, nnodes + 1 elements, the first string prop
+   of node i (see pycypher_string_props) is
+   strings[string_offsets[i]:string_offsets[i + 1]]
+ - "strings": the string pool
+ - "roots": unsigned int, indices of the root nodes
+and "type_names", a tuple mapping node types to their names (None for
+unknown types).
+*/
+PyObject* pycypher_build_flat_ast(const cypher_parse_result_t*);
+
+/* Add a new bytes object of the given size to the dict and return a pointer
+to its buffer, or NULL on failure.
+*/
+void* pycypher_add_flat_column(PyObject* columns, const char* name, size_t size);
+
+PyObject* pycypher_parse_query_flat(PyObject*, PyObject*);
+
+#endif
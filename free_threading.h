@@ -0,0 +1,31 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_FREE_THREADING_H
+#define PYCYPHER_FREE_THREADING_H
+#include <Python.h>
+
+/* Guard the lazily initialized fields of objects that threads may share.
+Free-threaded builds (3.13+) lock the object itself; builds with a GIL rely
+on it instead, since the guarded code never releases it.
+*/
+#if PY_VERSION_HEX >= 0x030D0000
+  #define PYCYPHER_BEGIN_CRITICAL_SECTION(op) Py_BEGIN_CRITICAL_SECTION(op)
+  #define PYCYPHER_END_CRITICAL_SECTION() Py_END_CRITICAL_SECTION()
+#else
+  #define PYCYPHER_BEGIN_CRITICAL_SECTION(op) {
+  #define PYCYPHER_END_CRITICAL_SECTION() }
+#endif
+
+#endif
@@ -0,0 +1,153 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "ingest.h"
+#include "parser.h"
+#include "flat.h"
+#include "fingerprint.h"
+
+#if PY_MAJOR_VERSION >= 3
+  #define PYCYPHER_BUFFER_FORMAT "y*"
+#else
+  #define PYCYPHER_BUFFER_FORMAT "s*"
+#endif
+
+typedef struct {
+  unsigned long long* offsets;
+  unsigned int* lengths;
+  unsigned int* nerrors;
+  long long* error_offsets;
+  unsigned long long* fingerprints;
+  unsigned int* nnodes;
+}
+pycypher_scan_t;
+
+static bool pycypher_is_blank(const char* line, size_t length) {
+  size_t i;
+  for(i=0; i<length; ++i)
+    if(line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+      return false;
+  return true;
+}
+
+/* Find the next non-blank line of data[0:length] at or after *offset, and
+store its offset and length. Return false if there is none.
+*/
+static bool pycypher_next_line(
+  const char* data, size_t length, size_t* offset, size_t* line_length
+) {
+  while(*offset < length) {
+    const char* newline = memchr(data + *offset, '\n', length - *offset);
+    *line_length = (newline == NULL ? length : (size_t)(newline - data)) - *offset;
+    if(!pycypher_is_blank(data + *offset, *line_length))
+      return true;
+    *offset += *line_length + 1;
+  }
+  return false;
+}
+
+static int pycypher_scan_line(
+  const pycypher_parser_options_t* options, pycypher_scan_t* scan, size_t i,
+  const char* query, size_t offset, size_t length
+) {
+  cypher_parse_result_t* parse_result;
+  uint64_t fingerprint;
+  int error = 0;
+  Py_BEGIN_ALLOW_THREADS
+  parse_result = pycypher_invoke_parser(options, query, length);
+  if(parse_result != NULL)
+    error = pycypher_fingerprint(parse_result, &fingerprint);
+  Py_END_ALLOW_THREADS
+  if(parse_result == NULL) {
+    PyErr_SetFromErrno(PyExc_OSError);
+    return -1;
+  }
+  if(error < 0) {
+    cypher_parse_result_free(parse_result);
+    PyErr_NoMemory();
+    return -1;
+  }
+  unsigned int nerrors = cypher_parse_result_nerrors(parse_result);
+  scan->offsets[i] = offset;
+  scan->lengths[i] = length;
+  scan->nerrors[i] = nerrors;
+  scan->error_offsets[i] = nerrors == 0 ? -1 : (long long)
+    cypher_parse_error_position(
+      cypher_parse_result_get_error(parse_result, 0)
+    ).offset;
+  scan->fingerprints[i] = fingerprint;
+  scan->nnodes[i] = cypher_parse_result_nnodes(parse_result);
+  cypher_parse_result_free(parse_result);
+  return 0;
+}
+
+PyObject* pycypher_scan_lines(PyObject* self, PyObject* args) {
+  Py_buffer buffer;
+  Py_ssize_t start;
+  Py_ssize_t end;
+  if (!PyArg_ParseTuple(
+      args, PYCYPHER_BUFFER_FORMAT "nn:scan_lines", &buffer, &start, &end
+  ))
+    return NULL;
+  if(start < 0 || end < start || end > buffer.len) {
+    PyBuffer_Release(&buffer);
+    PyErr_SetString(PyExc_ValueError, "Range out of buffer.");
+    return NULL;
+  }
+  const char* data = (const char*)buffer.buf + start;
+  size_t length = end - start;
+  size_t nqueries = 0;
+  size_t offset = 0;
+  size_t line_length;
+  for(; pycypher_next_line(data, length, &offset, &line_length);
+      offset += line_length + 1)
+    ++nqueries;
+
+  pycypher_scan_t scan;
+  PyObject* columns = PyDict_New();
+  if(columns == NULL ||
+      (scan.offsets = pycypher_add_flat_column(
+        columns, "offsets", nqueries * sizeof(*scan.offsets))) == NULL ||
+      (scan.lengths = pycypher_add_flat_column(
+        columns, "lengths", nqueries * sizeof(*scan.lengths))) == NULL ||
+      (scan.nerrors = pycypher_add_flat_column(
+        columns, "nerrors", nqueries * sizeof(*scan.nerrors))) == NULL ||
+      (scan.error_offsets = pycypher_add_flat_column(
+        columns, "error_offsets", nqueries * sizeof(*scan.error_offsets))) == NULL ||
+      (scan.fingerprints = pycypher_add_flat_column(
+        columns, "fingerprints", nqueries * sizeof(*scan.fingerprints))) == NULL ||
+      (scan.nnodes = pycypher_add_flat_column(
+        columns, "nnodes", nqueries * sizeof(*scan.nnodes))) == NULL) {
+    Py_XDECREF(columns);
+    PyBuffer_Release(&buffer);
+    return NULL;
+  }
+
+  const pycypher_parser_options_t* options = pycypher_parser_options(self);
+  size_t i = 0;
+  // The buffer stays exported, and so can't be resized, until released.
+  for(offset = 0; pycypher_next_line(data, length, &offset, &line_length);
+      offset += line_length + 1)
+    if(pycypher_scan_line(
+        options, &scan, i++, data + offset, start + offset, line_length
+    ) < 0) {
+      Py_DECREF(columns);
+      PyBuffer_Release(&buffer);
+      return NULL;
+    }
+  PyBuffer_Release(&buffer);
+  return columns;
+}
@@ -0,0 +1,32 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_INGEST_H
+#define PYCYPHER_INGEST_H
+#include <Python.h>
+
+/* Parse every non-blank line of buffer[start:end] as a separate query and
+return a dict of bytes objects holding flat arrays, one element per query:
+ - "offsets": unsigned long long, offset of the query in the buffer
+ - "lengths": unsigned int, length of the query in bytes, without the newline
+ - "nerrors": unsigned int, number of parse errors
+ - "error_offsets": long long, offset of the first error in the query, or -1
+ - "fingerprints": unsigned long long, see pycypher_fingerprint
+ - "nnodes": unsigned int, number of AST nodes
+Lines end at '\n'; blank lines, holding only spaces, tabs and '\r', are
+skipped. The GIL is released while each query is parsed and fingerprinted.
+*/
+PyObject* pycypher_scan_lines(PyObject*, PyObject*);
+
+#endif
@@ -0,0 +1,366 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "lazy.h"
+#include "parser.h"
+#include "free_threading.h"
+
+static void pycypher_ParseResult_dealloc(pycypher_ParseResult* self) {
+  if(self->parse_result != NULL)
+    cypher_parse_result_free(self->parse_result);
+  PyMem_Free(self->root_ordinals);
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+PyTypeObject pycypher_ParseResultType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "pycypher.bindings.ParseResult",           /* tp_name */
+  sizeof(pycypher_ParseResult),              /* tp_basicsize */
+  0,                                         /* tp_itemsize */
+  (destructor)pycypher_ParseResult_dealloc,  /* tp_dealloc */
+};
+
+PyObject* pycypher_wrap_parse_result(cypher_parse_result_t* parse_result) {
+  pycypher_ParseResult* self = PyObject_New(
+    pycypher_ParseResult, &pycypher_ParseResultType
+  );
+  if(self == NULL) {
+    cypher_parse_result_free(parse_result);
+    return NULL;
+  }
+  self->parse_result = parse_result;
+  self->root_ordinals = NULL;
+  return (PyObject*)self;
+}
+
+/* Set *ordinal to the id of the root of the given index. Return -1 when out
+of memory.
+*/
+static int pycypher_ParseResult_root_ordinal(
+  pycypher_ParseResult* self, unsigned int index, size_t* ordinal
+) {
+  int result = 0;
+  PYCYPHER_BEGIN_CRITICAL_SECTION(self);
+  if(self->root_ordinals == NULL) {
+    unsigned int nroots = cypher_parse_result_nroots(self->parse_result);
+    size_t* root_ordinals = PyMem_New(size_t, nroots);
+    size_t next_ordinal = 0;
+    unsigned int i;
+    for(i=0; root_ordinals != NULL && i<nroots; ++i) {
+      root_ordinals[i] = next_ordinal;
+      // The last root's size doesn't matter
+      if(i + 1 < nroots)
+        next_ordinal += pycypher_count_nodes(
+          cypher_parse_result_get_root(self->parse_result, i)
+        );
+    }
+    self->root_ordinals = root_ordinals;
+  }
+  if(self->root_ordinals == NULL)
+    result = -1;
+  else
+    *ordinal = self->root_ordinals[index];
+  PYCYPHER_END_CRITICAL_SECTION();
+  if(result < 0)
+    PyErr_NoMemory();
+  return result;
+}
+
+PyObject* pycypher_new_ast_node_ref(
+  PyObject* owner, const cypher_astnode_t* node, size_t ordinal,
+  unsigned int index
+) {
+  pycypher_AstNodeRef* self = PyObject_New(
+    pycypher_AstNodeRef, &pycypher_AstNodeRefType
+  );
+  if(self == NULL)
+    return NULL;
+  Py_INCREF(owner);
+  self->owner = owner;
+  self->node = node;
+  self->ordinal = ordinal;
+  self->index = index;
+  self->child_ordinals = NULL;
+  return (PyObject*)self;
+}
+
+static void pycypher_AstNodeRef_dealloc(pycypher_AstNodeRef* self) {
+  Py_DECREF(self->owner);
+  PyMem_Free(self->child_ordinals);
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/* Set *ordinal to the id of the node. Return -1 on failure. */
+static int pycypher_AstNodeRef_ordinal(
+  pycypher_AstNodeRef* self, size_t* ordinal
+) {
+  if(self->ordinal != PYCYPHER_ROOT_ORDINAL) {
+    *ordinal = self->ordinal;
+    return 0;
+  }
+  return pycypher_ParseResult_root_ordinal(
+    (pycypher_ParseResult*)self->owner, self->index, ordinal
+  );
+}
+
+/* Return the ids of the children of the node, computing them on first use,
+or NULL on failure. The result lives as long as the reference.
+*/
+static const size_t* pycypher_AstNodeRef_child_ordinals(
+  pycypher_AstNodeRef* self
+) {
+  size_t next_ordinal;
+  if(pycypher_AstNodeRef_ordinal(self, &next_ordinal) < 0)
+    return NULL;
+  const size_t* result;
+  PYCYPHER_BEGIN_CRITICAL_SECTION(self);
+  if(self->child_ordinals == NULL) {
+    unsigned int nchildren = cypher_astnode_nchildren(self->node);
+    // Allocate at least one so that NULL only means out of memory
+    size_t* child_ordinals = PyMem_New(size_t, nchildren + 1);
+    unsigned int i;
+    ++next_ordinal;
+    for(i=0; child_ordinals != NULL && i<nchildren; ++i) {
+      child_ordinals[i] = next_ordinal;
+      // The last child's size doesn't matter
+      if(i + 1 < nchildren)
+        next_ordinal += pycypher_count_nodes(
+          cypher_astnode_get_child(self->node, i)
+        );
+    }
+    self->child_ordinals = child_ordinals;
+  }
+  result = self->child_ordinals;
+  PYCYPHER_END_CRITICAL_SECTION();
+  if(result == NULL)
+    PyErr_NoMemory();
+  return result;
+}
+
+static PyObject* pycypher_AstNodeRef_get_id(pycypher_AstNodeRef* self, void* closure) {
+  size_t ordinal;
+  if(pycypher_AstNodeRef_ordinal(self, &ordinal) < 0)
+    return NULL;
+  return PyLong_FromSize_t(ordinal);
+}
+
+static PyObject* pycypher_AstNodeRef_get_type(pycypher_AstNodeRef* self, void* closure) {
+  PyObject* result = pycypher_node_type_name(self->node);
+  Py_INCREF(result);
+  return result;
+}
+
+static PyObject* pycypher_AstNodeRef_get_instanceof(pycypher_AstNodeRef* self, void* closure) {
+  PyObject* result = pycypher_node_type_instanceof(self->node);
+  Py_XINCREF(result);
+  return result;
+}
+
+static PyObject* pycypher_AstNodeRef_get_start(pycypher_AstNodeRef* self, void* closure) {
+  return Py_BuildValue("i", cypher_astnode_range(self->node).start.offset);
+}
+
+static PyObject* pycypher_AstNodeRef_get_end(pycypher_AstNodeRef* self, void* closure) {
+  return Py_BuildValue("i", cypher_astnode_range(self->node).end.offset);
+}
+
+static PyObject* pycypher_AstNodeRef_children(pycypher_AstNodeRef* self, PyObject* unused) {
+  const size_t* child_ordinals = pycypher_AstNodeRef_child_ordinals(self);
+  if(child_ordinals == NULL)
+    return NULL;
+  int nchildren = cypher_astnode_nchildren(self->node);
+  PyObject* result = PyList_New(nchildren);
+  if(result == NULL)
+    return NULL;
+  int i;
+  for(i=0; i<nchildren; ++i) {
+    PyObject* ref = pycypher_new_ast_node_ref(
+      self->owner, cypher_astnode_get_child(self->node, i), child_ordinals[i], i
+    );
+    if(ref == NULL) {
+      Py_DECREF(result);
+      return NULL;
+    }
+    // PyList_SetItem consumes a reference so no need to call Py_DECREF(ref)
+    PyList_SetItem(result, i, ref);
+  }
+  return result;
+}
+
+/* Find target in the subtree of src_ast, numbering its nodes in pre-order
+from *ordinal on. Return true with *ordinal set to the id of target if found.
+*/
+static bool pycypher_find_ordinal(
+  const cypher_astnode_t* src_ast, const cypher_astnode_t* target,
+  size_t* ordinal
+) {
+  if(src_ast == target)
+    return true;
+  ++*ordinal;
+  unsigned int nchildren = cypher_astnode_nchildren(src_ast);
+  unsigned int i;
+  for(i=0; i<nchildren; ++i)
+    if(pycypher_find_ordinal(cypher_astnode_get_child(src_ast, i), target, ordinal))
+      return true;
+  return false;
+}
+
+typedef struct {
+  pycypher_AstNodeRef* ref;
+  const size_t* child_ordinals;
+  Py_ssize_t nchildren;
+  Py_ssize_t cursor;
+  size_t ntargets;
+  // NULL while counting the targets
+  pycypher_ptr_map_t* ordinals;
+}
+pycypher_target_collector_t;
+
+/* Count src_target, or put its id into collector->ordinals. Most props refer
+to children, a few to deeper descendants. Targets outside of the subtree are
+left out, so that extracting them fails.
+*/
+static int pycypher_collect_target(
+  void* data, const cypher_astnode_t* src_target, PyObject* role
+) {
+  pycypher_target_collector_t* collector = data;
+  if(collector->ordinals == NULL) {
+    ++collector->ntargets;
+    return 0;
+  }
+  const cypher_astnode_t* src_ast = collector->ref->node;
+  Py_ssize_t i = pycypher_find_child(
+    src_ast, collector->nchildren, src_target, &collector->cursor
+  );
+  if(i >= 0) {
+    pycypher_ptr_map_put(
+      collector->ordinals, src_target, collector->child_ordinals[i]
+    );
+    return 0;
+  }
+  size_t ordinal;
+  if(pycypher_AstNodeRef_ordinal(collector->ref, &ordinal) < 0)
+    return -1;
+  if(pycypher_find_ordinal(src_ast, src_target, &ordinal))
+    pycypher_ptr_map_put(collector->ordinals, src_target, ordinal);
+  return 0;
+}
+
+static PyObject* pycypher_AstNodeRef_props(pycypher_AstNodeRef* self, PyObject* unused) {
+  pycypher_target_collector_t collector = {self, NULL, 0, 0, 0, NULL};
+  pycypher_ptr_map_t ordinals;
+  if(pycypher_visit_ast_props(self->node, pycypher_collect_target, &collector) < 0)
+    return NULL;
+  collector.child_ordinals = pycypher_AstNodeRef_child_ordinals(self);
+  if(collector.child_ordinals == NULL)
+    return NULL;
+  collector.nchildren = cypher_astnode_nchildren(self->node);
+  if(pycypher_ptr_map_init(&ordinals, collector.ntargets) < 0)
+    return PyErr_NoMemory();
+  collector.ordinals = &ordinals;
+  PyObject* result = pycypher_visit_ast_props(
+    self->node, pycypher_collect_target, &collector
+  ) < 0
+    ? NULL
+    : pycypher_extract_props(self->node, &ordinals);
+  pycypher_ptr_map_free(&ordinals);
+  return result;
+}
+
+static PyGetSetDef pycypher_AstNodeRef_getset[] = {
+  {"id", (getter)pycypher_AstNodeRef_get_id, NULL, NULL, NULL},
+  {"type", (getter)pycypher_AstNodeRef_get_type, NULL, NULL, NULL},
+  {"instanceof", (getter)pycypher_AstNodeRef_get_instanceof, NULL, NULL, NULL},
+  {"start", (getter)pycypher_AstNodeRef_get_start, NULL, NULL, NULL},
+  {"end", (getter)pycypher_AstNodeRef_get_end, NULL, NULL, NULL},
+  {NULL}
+};
+
+static PyMethodDef pycypher_AstNodeRef_methods[] = {
+  {
+    "children", (PyCFunction)pycypher_AstNodeRef_children, METH_NOARGS,
+    "Return a list of AstNodeRef instances for the children of the node."
+  },
+  {
+    "props", (PyCFunction)pycypher_AstNodeRef_props, METH_NOARGS,
+    "Return a dict of props of the node, see pycypher_extract_props."
+  },
+  {NULL}
+};
+
+PyTypeObject pycypher_AstNodeRefType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "pycypher.bindings.AstNodeRef",           /* tp_name */
+  sizeof(pycypher_AstNodeRef),              /* tp_basicsize */
+  0,                                        /* tp_itemsize */
+  (destructor)pycypher_AstNodeRef_dealloc,  /* tp_dealloc */
+};
+
+int pycypher_init_lazy(PyObject* module) {
+  pycypher_ParseResultType.tp_flags = Py_TPFLAGS_DEFAULT;
+  pycypher_ParseResultType.tp_doc = "Native parse result shared by AstNodeRef instances.";
+  if(PyType_Ready(&pycypher_ParseResultType) < 0)
+    return -1;
+  pycypher_AstNodeRefType.tp_flags = Py_TPFLAGS_DEFAULT;
+  pycypher_AstNodeRefType.tp_doc = "Reference to a node of a native parse result.";
+  pycypher_AstNodeRefType.tp_getset = pycypher_AstNodeRef_getset;
+  pycypher_AstNodeRefType.tp_methods = pycypher_AstNodeRef_methods;
+  if(PyType_Ready(&pycypher_AstNodeRefType) < 0)
+    return -1;
+  Py_INCREF(&pycypher_AstNodeRefType);
+  if(PyModule_AddObject(
+      module, "AstNodeRef", (PyObject*)&pycypher_AstNodeRefType
+  ) < 0) {
+    Py_DECREF(&pycypher_AstNodeRefType);
+    return -1;
+  }
+  return 0;
+}
+
+PyObject* pycypher_parse_query_lazy(PyObject* self, PyObject* args) {
+  char* query;
+  PyObject* exn_class;
+  if (!PyArg_ParseTuple(args, "Os:parse_lazy", &exn_class, &query))
+    return NULL;
+  const pycypher_parser_options_t* options = pycypher_parser_options(self);
+  cypher_parse_result_t* parse_result;
+  Py_BEGIN_ALLOW_THREADS
+  parse_result = pycypher_invoke_parser(options, query, strlen(query));
+  Py_END_ALLOW_THREADS
+  if(parse_result == NULL)
+    return PyErr_SetFromErrno(PyExc_OSError);
+  PyObject* owner = pycypher_wrap_parse_result(parse_result);
+  if(owner == NULL)
+    return NULL;
+
+  int nroots = cypher_parse_result_nroots(parse_result);
+  PyObject* ast_list = PyList_New(nroots);
+  int i;
+  for(i=0; ast_list != NULL && i<nroots; ++i) {
+    PyObject* ref = pycypher_new_ast_node_ref(
+      owner, cypher_parse_result_get_root(parse_result, i),
+      PYCYPHER_ROOT_ORDINAL, i
+    );
+    if(ref == NULL)
+      Py_CLEAR(ast_list);
+    else
+      // PyList_SetItem consumes a reference so no need to call Py_DECREF(ref)
+      PyList_SetItem(ast_list, i, ref);
+  }
+  PyObject* exn_list = ast_list == NULL
+    ? NULL
+    : pycypher_build_exn_list(exn_class, parse_result);
+  Py_DECREF(owner);
+  return Py_BuildValue("(NN)", ast_list, exn_list);
+}
@@ -0,0 +1,71 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_LAZY_H
+#define PYCYPHER_LAZY_H
+#include <Python.h>
+#include <cypher-parser.h>
+
+/* Owns a cypher_parse_result_t and frees it once the last AstNodeRef pointing
+into it is gone. root_ordinals holds the id of every root, the same as when
+building the whole tree at once, and is only filled when one is first needed.
+*/
+typedef struct {
+  PyObject_HEAD
+  cypher_parse_result_t* parse_result;
+  size_t* root_ordinals;
+}
+pycypher_ParseResult;
+
+/* A reference to a single node of a parse result. Exposes the node's id,
+type, instanceof, start and end as attributes and builds its children and
+props on demand, through children() and props().
+
+Ids are computed on demand as well: a root's comes from its owner, by index,
+and a child's is its parent's plus one plus the sizes of its earlier
+siblings' subtrees. child_ordinals caches the latter once computed.
+*/
+typedef struct {
+  PyObject_HEAD
+  PyObject* owner;
+  const cypher_astnode_t* node;
+  // The id of the node, or PYCYPHER_ROOT_ORDINAL for the root of the given index.
+  size_t ordinal;
+  unsigned int index;
+  size_t* child_ordinals;
+}
+pycypher_AstNodeRef;
+
+#define PYCYPHER_ROOT_ORDINAL ((size_t)-1)
+
+extern PyTypeObject pycypher_ParseResultType;
+extern PyTypeObject pycypher_AstNodeRefType;
+
+/* Ready the types and add them to the module. Return -1 on failure. */
+int pycypher_init_lazy(PyObject* module);
+
+/* Take ownership of the parse result and return a new ParseResult. The parse
+result is freed even if that fails.
+*/
+PyObject* pycypher_wrap_parse_result(cypher_parse_result_t*);
+/* Return a new reference to a node of owner with the given id, see
+pycypher_AstNodeRef for ordinal and index.
+*/
+PyObject* pycypher_new_ast_node_ref(
+  PyObject* owner, const cypher_astnode_t*, size_t ordinal, unsigned int index
+);
+
+PyObject* pycypher_parse_query_lazy(PyObject*, PyObject*);
+
+#endif
@@ -0,0 +1,253 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "literals.h"
+#include "parser.h"
+#include "flat.h"
+
+typedef struct {
+  unsigned char* kinds;
+  unsigned long long* starts;
+  unsigned long long* ends;
+  unsigned int* value_offsets;
+  char* values;
+  unsigned int nliterals;
+  unsigned int nvalues;
+}
+pycypher_literals_t;
+
+/* Return the kind of the node or -1 if it's not a literal. */
+static int pycypher_literal_kind(const cypher_astnode_t* src_ast) {
+  cypher_astnode_type_t type = cypher_astnode_type(src_ast);
+  if(type == CYPHER_AST_STRING)
+    return PYCYPHER_LITERAL_STRING;
+  if(type == CYPHER_AST_INTEGER)
+    return PYCYPHER_LITERAL_INTEGER;
+  if(type == CYPHER_AST_FLOAT)
+    return PYCYPHER_LITERAL_FLOAT;
+  if(type == CYPHER_AST_TRUE)
+    return PYCYPHER_LITERAL_TRUE;
+  if(type == CYPHER_AST_FALSE)
+    return PYCYPHER_LITERAL_FALSE;
+  if(type == CYPHER_AST_NULL)
+    return PYCYPHER_LITERAL_NULL;
+  if(type == CYPHER_AST_PARAMETER)
+    return PYCYPHER_LITERAL_PARAMETER;
+  return -1;
+}
+
+static const char* pycypher_literal_value(const cypher_astnode_t* src_ast, int kind) {
+  switch(kind) {
+    case PYCYPHER_LITERAL_STRING:
+      return cypher_ast_string_get_value(src_ast);
+    case PYCYPHER_LITERAL_INTEGER:
+      return cypher_ast_integer_get_valuestr(src_ast);
+    case PYCYPHER_LITERAL_FLOAT:
+      return cypher_ast_float_get_valuestr(src_ast);
+    case PYCYPHER_LITERAL_PARAMETER:
+      return cypher_ast_parameter_get_name(src_ast);
+    default:
+      return "";
+  }
+}
+
+/* Count (when literals->kinds is NULL) or store the literals of the
+subtree. Cypher doesn't allow parameters in variable length bounds, periodic
+commit sizes and field terminators, so their literals are left out and stay
+in the template.
+*/
+static void pycypher_collect_literals(
+  pycypher_literals_t* literals, const cypher_astnode_t* src_ast
+) {
+  int kind = pycypher_literal_kind(src_ast);
+  if(kind >= 0) {
+    const char* value = pycypher_literal_value(src_ast, kind);
+    size_t length = value == NULL ? 0 : strlen(value);
+    if(literals->kinds != NULL) {
+      unsigned int i = literals->nliterals;
+      struct cypher_input_range range = cypher_astnode_range(src_ast);
+      literals->kinds[i] = kind;
+      literals->starts[i] = range.start.offset;
+      literals->ends[i] = range.end.offset;
+      literals->value_offsets[i] = literals->nvalues;
+      memcpy(literals->values + literals->nvalues, value, length);
+    }
+    ++literals->nliterals;
+    literals->nvalues += length;
+    // Literals have no children worth visiting.
+    return;
+  }
+  cypher_astnode_type_t type = cypher_astnode_type(src_ast);
+  if(type == CYPHER_AST_RANGE || type == CYPHER_AST_USING_PERIODIC_COMMIT)
+    return;
+  const cypher_astnode_t* field_terminator = type == CYPHER_AST_LOAD_CSV
+    ? cypher_ast_load_csv_get_field_terminator(src_ast)
+    : NULL;
+  unsigned int nchildren = cypher_astnode_nchildren(src_ast);
+  unsigned int i;
+  for(i=0; i<nchildren; ++i) {
+    const cypher_astnode_t* child = cypher_astnode_get_child(src_ast, i);
+    if(child != field_terminator)
+      pycypher_collect_literals(literals, child);
+  }
+}
+
+/* A literal to sort by start, carrying the start so that the comparison
+needs no context and concurrent extractions don't share any state.
+*/
+typedef struct {
+  unsigned long long start;
+  unsigned int index;
+}
+pycypher_literal_order_t;
+
+static int pycypher_compare_literal_starts(const void* a, const void* b) {
+  const pycypher_literal_order_t* x = a;
+  const pycypher_literal_order_t* y = b;
+  if(x->start != y->start)
+    return x->start < y->start ? -1 : 1;
+  return x->index < y->index ? -1 : x->index > y->index;
+}
+
+/* Return the query with literals replaced by placeholders, as a string. */
+static PyObject* pycypher_build_template(
+  const pycypher_literals_t* literals, const char* query, size_t length,
+  const char* prefix
+) {
+  unsigned int n = literals->nliterals;
+  pycypher_literal_order_t* order = PyMem_Malloc(
+    (n ? n : 1) * sizeof(pycypher_literal_order_t)
+  );
+  unsigned int* numbers = PyMem_Malloc((n ? n : 1) * sizeof(unsigned int));
+  // Each placeholder is '$', the prefix and at most 10 digits.
+  size_t capacity = length + n * (strlen(prefix) + 11) + 1;
+  char* template = PyMem_Malloc(capacity);
+  PyObject* result = NULL;
+  unsigned int i;
+  if(order == NULL || numbers == NULL || template == NULL) {
+    PyErr_NoMemory();
+    goto cleanup;
+  }
+  // Placeholders are numbered in pre-order, but written in query order, in
+  // case children don't follow the order of the source.
+  unsigned int nplaceholders = 0;
+  for(i=0; i<n; ++i) {
+    order[i].start = literals->starts[i];
+    order[i].index = i;
+    numbers[i] = literals->kinds[i] == PYCYPHER_LITERAL_PARAMETER
+      ? 0
+      : nplaceholders++;
+  }
+  qsort(order, n, sizeof(pycypher_literal_order_t), pycypher_compare_literal_starts);
+
+  size_t pos = 0;
+  size_t out = 0;
+  for(i=0; i<n; ++i) {
+    unsigned int j = order[i].index;
+    size_t start = literals->starts[j];
+    size_t end = literals->ends[j];
+    if(literals->kinds[j] == PYCYPHER_LITERAL_PARAMETER ||
+        start < pos || end > length)
+      continue;
+    memcpy(template + out, query + pos, start - pos);
+    out += start - pos;
+    out += sprintf(template + out, "$%s%u", prefix, numbers[j]);
+    pos = end;
+  }
+  memcpy(template + out, query + pos, length - pos);
+  out += length - pos;
+  result = PyUnicode_DecodeUTF8(template, out, "replace");
+
+cleanup:
+  PyMem_Free(order);
+  PyMem_Free(numbers);
+  PyMem_Free(template);
+  return result;
+}
+
+PyObject* pycypher_build_literals(
+  const cypher_parse_result_t* parse_result, const char* query, size_t length,
+  const char* prefix
+) {
+  pycypher_literals_t literals;
+  unsigned int nroots = cypher_parse_result_nroots(parse_result);
+  unsigned int i;
+
+  memset(&literals, 0, sizeof(literals));
+  for(i=0; i<nroots; ++i)
+    pycypher_collect_literals(&literals, cypher_parse_result_get_root(parse_result, i));
+
+  PyObject* columns = PyDict_New();
+  if(columns == NULL)
+    return NULL;
+  if(
+      (literals.kinds = pycypher_add_flat_column(
+        columns, "kinds", literals.nliterals * sizeof(*literals.kinds))) == NULL ||
+      (literals.starts = pycypher_add_flat_column(
+        columns, "starts", literals.nliterals * sizeof(*literals.starts))) == NULL ||
+      (literals.ends = pycypher_add_flat_column(
+        columns, "ends", literals.nliterals * sizeof(*literals.ends))) == NULL ||
+      (literals.value_offsets = pycypher_add_flat_column(
+        columns, "value_offsets", (literals.nliterals + 1) * sizeof(*literals.value_offsets))) == NULL ||
+      (literals.values = pycypher_add_flat_column(
+        columns, "values", literals.nvalues)) == NULL
+  ) {
+    Py_DECREF(columns);
+    return NULL;
+  }
+
+  literals.nliterals = 0;
+  literals.nvalues = 0;
+  for(i=0; i<nroots; ++i)
+    pycypher_collect_literals(&literals, cypher_parse_result_get_root(parse_result, i));
+  literals.value_offsets[literals.nliterals] = literals.nvalues;
+
+  PyObject* template = pycypher_build_template(&literals, query, length, prefix);
+  if(template == NULL ||
+      PyDict_SetItemString(columns, "template", template) < 0) {
+    Py_XDECREF(template);
+    Py_DECREF(columns);
+    return NULL;
+  }
+  Py_DECREF(template);
+  return columns;
+}
+
+PyObject* pycypher_extract_literals(PyObject* self, PyObject* args) {
+  char* query;
+  char* prefix;
+  PyObject* exn_class;
+  if (!PyArg_ParseTuple(
+      args, "Oss:extract_literals", &exn_class, &query, &prefix
+  ))
+    return NULL;
+  const pycypher_parser_options_t* options = pycypher_parser_options(self);
+  size_t length = strlen(query);
+  cypher_parse_result_t* parse_result;
+  Py_BEGIN_ALLOW_THREADS
+  parse_result = pycypher_invoke_parser(options, query, length);
+  Py_END_ALLOW_THREADS
+  if(parse_result == NULL)
+    return PyErr_SetFromErrno(PyExc_OSError);
+  PyObject* columns = pycypher_build_literals(parse_result, query, length, prefix);
+  PyObject* exn_list = columns == NULL
+    ? NULL
+    : pycypher_build_exn_list(exn_class, parse_result);
+  cypher_parse_result_free(parse_result);
+  if(exn_list == NULL) {
+    Py_XDECREF(columns);
+    return NULL;
+  }
+  return Py_BuildValue("(NN)", columns, exn_list);
+}
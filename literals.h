@@ -0,0 +1,49 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_LITERALS_H
+#define PYCYPHER_LITERALS_H
+#include <Python.h>
+#include <cypher-parser.h>
+
+typedef enum {
+  PYCYPHER_LITERAL_STRING = 0,
+  PYCYPHER_LITERAL_INTEGER = 1,
+  PYCYPHER_LITERAL_FLOAT = 2,
+  PYCYPHER_LITERAL_TRUE = 3,
+  PYCYPHER_LITERAL_FALSE = 4,
+  PYCYPHER_LITERAL_NULL = 5,
+  PYCYPHER_LITERAL_PARAMETER = 6
+}
+pycypher_literal_kind_t;
+
+/* Return a dict describing all literals and parameters of the parse result,
+in pre-order, as flat arrays in the style of pycypher_build_flat_ast:
+ - "kinds": unsigned char, pycypher_literal_kind_t
+ - "starts", "ends": unsigned long long, offsets in the query
+ - "value_offsets": unsigned int, n + 1 elements, the value of literal i (the
+   unescaped string, the digits of a number, the name of a parameter, empty
+   for true, false and null) is values[value_offsets[i]:value_offsets[i + 1]]
+ - "values": the string pool
+and "template", the query with the k-th literal (not counting parameters)
+replaced by $<prefix>k.
+*/
+PyObject* pycypher_build_literals(
+  const cypher_parse_result_t*, const char* query, size_t length,
+  const char* prefix
+);
+
+PyObject* pycypher_extract_literals(PyObject*, PyObject*);
+
+#endif
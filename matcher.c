@@ -0,0 +1,583 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <ctype.h>
+#include "matcher.h"
+#include "parser.h"
+
+#define PYCYPHER_TYPE_PREFIX "CYPHER_AST_"
+
+static void pycypher_free_pattern(pycypher_pattern_t* pattern) {
+  size_t i, j;
+  for(i=0; i<pattern->nsteps; ++i) {
+    for(j=0; j<pattern->steps[i].nconds; ++j) {
+      PyMem_Free(pattern->steps[i].conds[j].name);
+      PyMem_Free(pattern->steps[i].conds[j].value);
+    }
+    PyMem_Free(pattern->steps[i].conds);
+  }
+  PyMem_Free(pattern->steps);
+}
+
+typedef struct {
+  const char* source;
+  const char* pos;
+}
+pycypher_pattern_reader_t;
+
+static int pycypher_pattern_error(pycypher_pattern_reader_t* r, const char* what) {
+  PyErr_Format(
+    PyExc_ValueError, "Invalid pattern '%s': %s at offset %d",
+    r->source, what, (int)(r->pos - r->source)
+  );
+  return -1;
+}
+
+static void pycypher_skip_spaces(pycypher_pattern_reader_t* r) {
+  while(isspace((unsigned char)*r->pos))
+    ++r->pos;
+}
+
+static bool pycypher_is_name_char(char c) {
+  return isalnum((unsigned char)c) || c == '_';
+}
+
+/* Read a name or a quoted string into a new buffer. Return NULL with an
+exception set on failure.
+*/
+static char* pycypher_read_word(pycypher_pattern_reader_t* r, bool allow_quotes) {
+  const char* start;
+  const char* end;
+  pycypher_skip_spaces(r);
+  start = r->pos;
+  if(allow_quotes && (*start == '\'' || *start == '"')) {
+    end = strchr(start + 1, *start);
+    if(end == NULL) {
+      pycypher_pattern_error(r, "unterminated string");
+      return NULL;
+    }
+    ++start;
+    r->pos = end + 1;
+  } else {
+    while(pycypher_is_name_char(*r->pos))
+      ++r->pos;
+    end = r->pos;
+    if(end == start) {
+      pycypher_pattern_error(r, "expected a name");
+      return NULL;
+    }
+  }
+  char* result = PyMem_Malloc(end - start + 1);
+  if(result == NULL) {
+    PyErr_NoMemory();
+    return NULL;
+  }
+  memcpy(result, start, end - start);
+  result[end - start] = '\0';
+  return result;
+}
+
+static int pycypher_resolve_type(
+  pycypher_pattern_reader_t* r, const char* name, pycypher_pattern_step_t* step
+) {
+  size_t prefix_len = strlen(PYCYPHER_TYPE_PREFIX);
+  size_t i;
+  for(i=0; i<pycypher_node_types_len; ++i) {
+    const char* type_name = pycypher_node_types[i].name;
+    if(strcmp(type_name, name) == 0 || (
+        strncmp(type_name, PYCYPHER_TYPE_PREFIX, prefix_len) == 0 &&
+        strcmp(type_name + prefix_len, name) == 0
+    )) {
+      step->type = pycypher_node_types[i].node_type;
+      return 0;
+    }
+  }
+  return pycypher_pattern_error(r, "unknown node type");
+}
+
+static int pycypher_read_cond(
+  pycypher_pattern_reader_t* r, pycypher_pattern_cond_t* cond
+) {
+  pycypher_skip_spaces(r);
+  cond->kind = PYCYPHER_COND_PRESENT;
+  if(*r->pos == '!') {
+    cond->kind = PYCYPHER_COND_ABSENT;
+    ++r->pos;
+  } else if(*r->pos == '@') {
+    cond->kind = PYCYPHER_COND_ROLE;
+    ++r->pos;
+  }
+  if((cond->name = pycypher_read_word(r, false)) == NULL)
+    return -1;
+  pycypher_skip_spaces(r);
+  if(cond->kind == PYCYPHER_COND_PRESENT && *r->pos == '=') {
+    ++r->pos;
+    cond->kind = PYCYPHER_COND_EQUALS;
+    if((cond->value = pycypher_read_word(r, true)) == NULL)
+      return -1;
+    pycypher_skip_spaces(r);
+  }
+  return 0;
+}
+
+static int pycypher_read_step(
+  pycypher_pattern_reader_t* r, pycypher_pattern_step_t* step
+) {
+  pycypher_skip_spaces(r);
+  if(*r->pos == '*') {
+    step->any_type = true;
+    ++r->pos;
+  } else {
+    char* name = pycypher_read_word(r, false);
+    if(name == NULL)
+      return -1;
+    int result = pycypher_resolve_type(r, name, step);
+    PyMem_Free(name);
+    if(result < 0)
+      return -1;
+  }
+  pycypher_skip_spaces(r);
+  if(*r->pos != '[')
+    return 0;
+  ++r->pos;
+  for(;;) {
+    pycypher_pattern_cond_t* conds = PyMem_Realloc(
+      step->conds, (step->nconds + 1) * sizeof(pycypher_pattern_cond_t)
+    );
+    if(conds == NULL) {
+      PyErr_NoMemory();
+      return -1;
+    }
+    step->conds = conds;
+    memset(&conds[step->nconds], 0, sizeof(pycypher_pattern_cond_t));
+    if(pycypher_read_cond(r, &conds[step->nconds++]) < 0)
+      return -1;
+    if(*r->pos == ']') {
+      ++r->pos;
+      return 0;
+    }
+    if(*r->pos != ',')
+      return pycypher_pattern_error(r, "expected ',' or ']'");
+    ++r->pos;
+  }
+}
+
+static int pycypher_compile_pattern(const char* source, pycypher_pattern_t* pattern) {
+  pycypher_pattern_reader_t r = {source, source};
+  bool descendant = false;
+  for(;;) {
+    pycypher_pattern_step_t* steps = PyMem_Realloc(
+      pattern->steps, (pattern->nsteps + 1) * sizeof(pycypher_pattern_step_t)
+    );
+    if(steps == NULL) {
+      PyErr_NoMemory();
+      return -1;
+    }
+    pattern->steps = steps;
+    memset(&steps[pattern->nsteps], 0, sizeof(pycypher_pattern_step_t));
+    steps[pattern->nsteps].descendant = descendant;
+    if(pycypher_read_step(&r, &steps[pattern->nsteps++]) < 0)
+      return -1;
+    pycypher_skip_spaces(&r);
+    if(*r.pos == '\0')
+      return 0;
+    if(r.pos[0] == '>' && r.pos[1] == '>') {
+      descendant = true;
+      r.pos += 2;
+    } else if(r.pos[0] == '>') {
+      descendant = false;
+      r.pos += 1;
+    } else {
+      return pycypher_pattern_error(&r, "expected '>' or '>>'");
+    }
+  }
+}
+
+/* Compare an operator or direction name to a value given with or without
+its prefix.
+*/
+static bool pycypher_name_equals(const char* name, const char* value) {
+  size_t name_len = strlen(name);
+  size_t value_len = strlen(value);
+  if(strcmp(name, value) == 0)
+    return true;
+  return value_len < name_len && name[name_len - value_len - 1] == '_' &&
+    strcmp(name + name_len - value_len, value) == 0;
+}
+
+/* Return 1 if the prop is set (or equals the value, if given), 0 if not and
+-1 if the node has no such prop.
+*/
+static int pycypher_check_prop(
+  const cypher_astnode_t* node, const pycypher_prop_ref_t* ref, const char* value
+) {
+  switch(ref->kind) {
+    case PYCYPHER_DIRECTION_PROP: {
+      const pycypher_direction_prop_t* prop = ref->prop;
+      return value == NULL ||
+        pycypher_name_equals(pycypher_direction_name(prop->getter(node)), value);
+    }
+    case PYCYPHER_OPERATOR_PROP: {
+      const pycypher_operator_prop_t* prop = ref->prop;
+      return value == NULL ||
+        pycypher_name_equals(pycypher_operator_name(prop->getter(node)), value);
+    }
+    case PYCYPHER_OPERATOR_LIST_PROP: {
+      const pycypher_operator_list_prop_t* prop = ref->prop;
+      unsigned int n = prop->length_getter(node);
+      unsigned int i;
+      if(value == NULL)
+        return n > 0;
+      for(i=0; i<n; ++i)
+        if(pycypher_name_equals(pycypher_operator_name(prop->list_getter(node, i)), value))
+          return 1;
+      return 0;
+    }
+    case PYCYPHER_BOOL_PROP: {
+      const pycypher_bool_prop_t* prop = ref->prop;
+      bool actual = prop->getter(node);
+      if(value == NULL)
+        return actual;
+      return actual == (strcmp(value, "true") == 0);
+    }
+    case PYCYPHER_STRING_PROP: {
+      const pycypher_string_prop_t* prop = ref->prop;
+      const char* actual = prop->getter(node);
+      if(value == NULL || actual == NULL)
+        return actual != NULL;
+      return strcmp(actual, value) == 0;
+    }
+    case PYCYPHER_AST_LIST_PROP: {
+      const pycypher_ast_list_prop_t* prop = ref->prop;
+      return value == NULL && prop->length_getter(node) > 0;
+    }
+    case PYCYPHER_AST_LIST_PLUS_ONE_PROP:
+      return value == NULL;
+    case PYCYPHER_AST_PROP: {
+      const pycypher_ast_prop_t* prop = ref->prop;
+      return value == NULL && prop->getter(node) != NULL;
+    }
+  }
+  return 0;
+}
+
+/* Return whether the parent refers to the node through a prop with the
+role.
+*/
+static bool pycypher_has_role(
+  const cypher_astnode_t* parent, const cypher_astnode_t* node,
+  const pycypher_prop_plan_t* plan, const char* role
+) {
+  size_t i;
+  unsigned int j, n;
+  for(i=0; i<plan->len; ++i) {
+    const pycypher_prop_ref_t* ref = &plan->refs[i];
+    switch(ref->kind) {
+      case PYCYPHER_AST_PROP: {
+        const pycypher_ast_prop_t* prop = ref->prop;
+        if(strcmp(prop->name, role) == 0 && prop->getter(parent) == node)
+          return true;
+        break;
+      }
+      case PYCYPHER_AST_LIST_PROP: {
+        const pycypher_ast_list_prop_t* prop = ref->prop;
+        if(strcmp(prop->role, role) != 0)
+          break;
+        n = prop->length_getter(parent);
+        for(j=0; j<n; ++j)
+          if(prop->list_getter(parent, j) == node)
+            return true;
+        break;
+      }
+      case PYCYPHER_AST_LIST_PLUS_ONE_PROP: {
+        const pycypher_ast_list_plus_one_prop_t* prop = ref->prop;
+        if(strcmp(prop->role, role) != 0)
+          break;
+        n = prop->length_getter(parent) + 1;
+        for(j=0; j<n; ++j)
+          if(prop->list_getter(parent, j) == node)
+            return true;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return false;
+}
+
+/* Return 1 if the node matches the step, 0 if not and -1 on error. */
+static int pycypher_step_matches(
+  const pycypher_pattern_step_t* step, const cypher_astnode_t* node,
+  const cypher_astnode_t* parent
+) {
+  size_t i, j;
+  if(!step->any_type && !cypher_astnode_instanceof(node, step->type))
+    return 0;
+  if(step->nconds == 0)
+    return 1;
+  const pycypher_prop_plan_t* plan = pycypher_get_prop_plan(node);
+  if(plan == NULL)
+    return -1;
+  for(i=0; i<step->nconds; ++i) {
+    const pycypher_pattern_cond_t* cond = &step->conds[i];
+    if(cond->kind == PYCYPHER_COND_ROLE) {
+      if(parent == NULL)
+        return 0;
+      const pycypher_prop_plan_t* parent_plan = pycypher_get_prop_plan(parent);
+      if(parent_plan == NULL)
+        return -1;
+      if(!pycypher_has_role(parent, node, parent_plan, cond->name))
+        return 0;
+      continue;
+    }
+    int found = 0;
+    for(j=0; j<plan->len; ++j)
+      if(strcmp(pycypher_prop_ref_name(&plan->refs[j]), cond->name) == 0) {
+        found = pycypher_check_prop(node, &plan->refs[j], cond->value) ? 1 : -1;
+        break;
+      }
+    // Nodes without the prop at all count as not having it set.
+    if((found == 1) != (cond->kind != PYCYPHER_COND_ABSENT))
+      return 0;
+  }
+  return 1;
+}
+
+/* Return 1 if steps [0, step] match ancestors[0, limit), with step matching
+ancestors[limit - 1] if the following step is a child, and any of them if it
+is a descendant. Return -1 on error.
+*/
+static int pycypher_match_ancestors(
+  const pycypher_pattern_t* pattern, long step,
+  const cypher_astnode_t** ancestors, size_t limit
+) {
+  if(step < 0)
+    return 1;
+  bool descendant = pattern->steps[step + 1].descendant;
+  size_t k = limit;
+  while(k-- > 0) {
+    int result = pycypher_step_matches(
+      &pattern->steps[step], ancestors[k], k > 0 ? ancestors[k - 1] : NULL
+    );
+    if(result == 1)
+      result = pycypher_match_ancestors(pattern, step - 1, ancestors, k);
+    if(result != 0)
+      return result;
+    if(!descendant)
+      break;
+  }
+  return 0;
+}
+
+typedef struct {
+  const pycypher_Matcher* matcher;
+  const cypher_astnode_t** ancestors;
+  size_t depth;
+  size_t capacity;
+  PyObject* matches;
+}
+pycypher_match_ctx_t;
+
+static int pycypher_match_node(
+  pycypher_match_ctx_t* ctx, const cypher_astnode_t* node
+) {
+  size_t i;
+  const cypher_astnode_t* parent = ctx->depth > 0
+    ? ctx->ancestors[ctx->depth - 1]
+    : NULL;
+  for(i=0; i<ctx->matcher->npatterns; ++i) {
+    const pycypher_pattern_t* pattern = &ctx->matcher->patterns[i];
+    int result = pycypher_step_matches(
+      &pattern->steps[pattern->nsteps - 1], node, parent
+    );
+    if(result == 1)
+      result = pycypher_match_ancestors(
+        pattern, (long)pattern->nsteps - 2, ctx->ancestors, ctx->depth
+      );
+    if(result < 0) {
+      PyErr_NoMemory();
+      return -1;
+    }
+    if(result == 1) {
+      struct cypher_input_range range = cypher_astnode_range(node);
+      PyObject* match = Py_BuildValue(
+        "(Onn)", pycypher_node_type_name(node),
+        (Py_ssize_t)range.start.offset, (Py_ssize_t)range.end.offset
+      );
+      if(match == NULL ||
+          PyList_Append(PyList_GET_ITEM(ctx->matches, i), match) < 0) {
+        Py_XDECREF(match);
+        return -1;
+      }
+      Py_DECREF(match);
+    }
+  }
+
+  unsigned int nchildren = cypher_astnode_nchildren(node);
+  if(nchildren == 0)
+    return 0;
+  if(ctx->depth == ctx->capacity) {
+    size_t capacity = ctx->capacity ? ctx->capacity * 2 : 32;
+    const cypher_astnode_t** ancestors = PyMem_Realloc(
+      ctx->ancestors, capacity * sizeof(const cypher_astnode_t*)
+    );
+    if(ancestors == NULL) {
+      PyErr_NoMemory();
+      return -1;
+    }
+    ctx->ancestors = ancestors;
+    ctx->capacity = capacity;
+  }
+  ctx->ancestors[ctx->depth++] = node;
+  for(i=0; i<nchildren; ++i)
+    if(pycypher_match_node(ctx, cypher_astnode_get_child(node, i)) < 0)
+      return -1;
+  --ctx->depth;
+  return 0;
+}
+
+static PyObject* pycypher_Matcher_new(
+  PyTypeObject* type, PyObject* args, PyObject* kwargs
+) {
+  static char* kwlist[] = {"patterns", NULL};
+  PyObject* patterns;
+  if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O:Matcher", kwlist, &patterns))
+    return NULL;
+  PyObject* seq = PySequence_Fast(patterns, "patterns must be a sequence");
+  if(seq == NULL)
+    return NULL;
+  pycypher_Matcher* self = (pycypher_Matcher*)type->tp_alloc(type, 0);
+  if(self == NULL) {
+    Py_DECREF(seq);
+    return NULL;
+  }
+  Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+  self->patterns = PyMem_Malloc((n ? n : 1) * sizeof(pycypher_pattern_t));
+  if(self->patterns == NULL) {
+    Py_DECREF(seq);
+    Py_DECREF(self);
+    return PyErr_NoMemory();
+  }
+  Py_ssize_t i;
+  for(i=0; i<n; ++i) {
+    const char* source;
+#if PY_MAJOR_VERSION >= 3
+    source = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(seq, i));
+#else
+    source = PyString_AsString(PySequence_Fast_GET_ITEM(seq, i));
+#endif
+    memset(&self->patterns[i], 0, sizeof(pycypher_pattern_t));
+    self->npatterns = i + 1;
+    if(source == NULL || pycypher_compile_pattern(source, &self->patterns[i]) < 0) {
+      Py_DECREF(seq);
+      Py_DECREF(self);
+      return NULL;
+    }
+  }
+  Py_DECREF(seq);
+  return (PyObject*)self;
+}
+
+static void pycypher_Matcher_dealloc(pycypher_Matcher* self) {
+  size_t i;
+  for(i=0; i<self->npatterns; ++i)
+    pycypher_free_pattern(&self->patterns[i]);
+  PyMem_Free(self->patterns);
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/* Return a list with a list of (type, start, end) tuples per pattern, one
+for each node of the parse result matching it, in pre-order.
+*/
+static PyObject* pycypher_Matcher_match_result(
+  pycypher_Matcher* self, const cypher_parse_result_t* parse_result
+) {
+  pycypher_match_ctx_t ctx;
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.matcher = self;
+  ctx.matches = PyList_New(self->npatterns);
+  size_t i;
+  for(i=0; ctx.matches != NULL && i<self->npatterns; ++i) {
+    PyObject* list = PyList_New(0);
+    if(list == NULL)
+      Py_CLEAR(ctx.matches);
+    else
+      PyList_SET_ITEM(ctx.matches, i, list);
+  }
+  unsigned int nroots = cypher_parse_result_nroots(parse_result);
+  for(i=0; ctx.matches != NULL && i<nroots; ++i)
+    if(pycypher_match_node(&ctx, cypher_parse_result_get_root(parse_result, i)) < 0)
+      Py_CLEAR(ctx.matches);
+  PyMem_Free(ctx.ancestors);
+  return ctx.matches;
+}
+
+static PyObject* pycypher_Matcher_match_query(pycypher_Matcher* self, PyObject* args) {
+  char* query;
+  PyObject* exn_class;
+  PyObject* parser = NULL;
+  if (!PyArg_ParseTuple(args, "Os|O:match_query", &exn_class, &query, &parser))
+    return NULL;
+  const pycypher_parser_options_t* options = pycypher_parser_options(parser);
+  cypher_parse_result_t* parse_result;
+  Py_BEGIN_ALLOW_THREADS
+  parse_result = pycypher_invoke_parser(options, query, strlen(query));
+  Py_END_ALLOW_THREADS
+  if(parse_result == NULL)
+    return PyErr_SetFromErrno(PyExc_OSError);
+  PyObject* matches = pycypher_Matcher_match_result(self, parse_result);
+  PyObject* exn_list = matches == NULL
+    ? NULL
+    : pycypher_build_exn_list(exn_class, parse_result);
+  cypher_parse_result_free(parse_result);
+  if(exn_list == NULL) {
+    Py_XDECREF(matches);
+    return NULL;
+  }
+  return Py_BuildValue("(NN)", matches, exn_list);
+}
+
+static PyMethodDef pycypher_Matcher_methods[] = {
+  {
+    "match_query", (PyCFunction)pycypher_Matcher_match_query, METH_VARARGS,
+    "Parse the query and return the matches of every pattern and a list of"
+    " errors. The query is parsed with the options of the given Parser or"
+    " module, the defaults otherwise."
+  },
+  {NULL}
+};
+
+PyTypeObject pycypher_MatcherType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "pycypher.bindings.Matcher",           /* tp_name */
+  sizeof(pycypher_Matcher),              /* tp_basicsize */
+  0,                                     /* tp_itemsize */
+  (destructor)pycypher_Matcher_dealloc,  /* tp_dealloc */
+};
+
+int pycypher_init_matcher(PyObject* module) {
+  pycypher_MatcherType.tp_flags = Py_TPFLAGS_DEFAULT;
+  pycypher_MatcherType.tp_doc = "Compiled structural patterns over parse results.";
+  pycypher_MatcherType.tp_new = pycypher_Matcher_new;
+  pycypher_MatcherType.tp_methods = pycypher_Matcher_methods;
+  if(PyType_Ready(&pycypher_MatcherType) < 0)
+    return -1;
+  Py_INCREF(&pycypher_MatcherType);
+  if(PyModule_AddObject(module, "Matcher", (PyObject*)&pycypher_MatcherType) < 0) {
+    Py_DECREF(&pycypher_MatcherType);
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,84 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_MATCHER_H
+#define PYCYPHER_MATCHER_H
+#include <stdbool.h>
+#include <Python.h>
+#include <cypher-parser.h>
+
+/* Structural patterns, similar to CSS selectors:
+
+  pattern := step (combinator step)*
+  combinator := '>' (child) | '>>' (descendant)
+  step := type ('[' cond (',' cond)* ']')?
+  type := '*' | node type, with or without the CYPHER_AST_ prefix
+  cond := prop | '!' prop | prop '=' value | '@' role
+
+A step matches nodes that are instances of its type and satisfy all of its
+conditions. A bare prop has to be set (non-empty list, non-NULL node or
+string, true bool), '!' negates that. prop '=' value compares string, bool,
+operator and direction props, the latter two with or without their
+CYPHER_OP_ / CYPHER_REL_ prefix. '@' role requires the node to be referred to
+by a prop of its parent with that role, e.g. @limit or @clause. A pattern
+matches the node matching its last step.
+*/
+typedef enum {
+  PYCYPHER_COND_PRESENT,
+  PYCYPHER_COND_ABSENT,
+  PYCYPHER_COND_EQUALS,
+  PYCYPHER_COND_ROLE
+}
+pycypher_pattern_cond_kind_t;
+
+typedef struct {
+  pycypher_pattern_cond_kind_t kind;
+  char* name;
+  char* value;
+}
+pycypher_pattern_cond_t;
+
+typedef struct {
+  // Whether the step relates to the previous one as a descendant rather than
+  // as a child. Unused for the first step.
+  bool descendant;
+  bool any_type;
+  cypher_astnode_type_t type;
+  size_t nconds;
+  pycypher_pattern_cond_t* conds;
+}
+pycypher_pattern_step_t;
+
+typedef struct {
+  size_t nsteps;
+  pycypher_pattern_step_t* steps;
+}
+pycypher_pattern_t;
+
+/* A set of compiled patterns, all of which are checked in a single walk over
+a parse result.
+*/
+typedef struct {
+  PyObject_HEAD
+  size_t npatterns;
+  pycypher_pattern_t* patterns;
+}
+pycypher_Matcher;
+
+extern PyTypeObject pycypher_MatcherType;
+
+/* Ready the Matcher type and add it to the module. Return -1 on failure. */
+int pycypher_init_matcher(PyObject* module);
+
+#endif
@@ -0,0 +1,92 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdbool.h>
+#include "node_type_info.h"
+
+#if PY_MAJOR_VERSION >= 3
+  #define PYCYPHER_INTERN_STRING PyUnicode_InternFromString
+#else
+  #define PYCYPHER_INTERN_STRING PyString_InternFromString
+#endif
+
+static pycypher_node_type_info_t pycypher_node_type_info[PYCYPHER_NODE_TYPES_CAPACITY];
+static PyObject* pycypher_unknown_type_name;
+
+int pycypher_init_node_type_info(void) {
+  size_t i;
+  pycypher_unknown_type_name = PYCYPHER_INTERN_STRING("CYPHER_AST_UNKNOWN");
+  if(pycypher_unknown_type_name == NULL)
+    return -1;
+  for(i=0; i<pycypher_node_types_len; ++i) {
+    pycypher_node_type_info_t* info =
+      &pycypher_node_type_info[pycypher_node_types[i].node_type];
+    Py_XDECREF(info->name);
+    info->name = PYCYPHER_INTERN_STRING(pycypher_node_types[i].name);
+    if(info->name == NULL)
+      return -1;
+  }
+  return 0;
+}
+
+PyObject* pycypher_node_type_name(const cypher_astnode_t* src_ast) {
+  PyObject* name = pycypher_node_type_info[cypher_astnode_type(src_ast)].name;
+  if(name == NULL)
+    return pycypher_unknown_type_name;
+  return name;
+}
+
+static PyObject* pycypher_build_node_type_instanceof(const cypher_astnode_t* src_ast) {
+  size_t n = 0;
+  size_t i;
+  for(i=0; i<pycypher_node_types_len; ++i)
+    if(cypher_astnode_instanceof(src_ast, pycypher_node_types[i].node_type))
+      ++n;
+  PyObject* result = PyTuple_New(n);
+  if(result == NULL)
+    return NULL;
+  n = 0;
+  for(i=0; i<pycypher_node_types_len; ++i)
+    if(cypher_astnode_instanceof(src_ast, pycypher_node_types[i].node_type)) {
+      PyObject* name =
+        pycypher_node_type_info[pycypher_node_types[i].node_type].name;
+      Py_INCREF(name);
+      // PyTuple_SET_ITEM steals a reference
+      PyTuple_SET_ITEM(result, n++, name);
+    }
+  return result;
+}
+
+PyObject* pycypher_node_type_instanceof(const cypher_astnode_t* src_ast) {
+  pycypher_node_type_info_t* info =
+    &pycypher_node_type_info[cypher_astnode_type(src_ast)];
+  // Which types a node is an instance of depends only on its own type, but
+  // libcypher-parser can only answer that for a node, so the tuple is built
+  // from the first node of each type. Threads running without a GIL may
+  // build it concurrently, the first one stored is kept.
+  PyObject* instanceof = __atomic_load_n(&info->instanceof, __ATOMIC_ACQUIRE);
+  if(instanceof == NULL) {
+    PyObject* built = pycypher_build_node_type_instanceof(src_ast);
+    if(built == NULL)
+      return NULL;
+    if(__atomic_compare_exchange_n(
+        &info->instanceof, &instanceof, built, false,
+        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+    ))
+      instanceof = built;
+    else
+      Py_DECREF(built);
+  }
+  return instanceof;
+}
@@ -0,0 +1,43 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_NODE_TYPE_INFO_H
+#define PYCYPHER_NODE_TYPE_INFO_H
+#include <Python.h>
+#include <cypher-parser.h>
+#include "node_types.h"
+
+/* Python objects describing a single node type, shared by every node of that
+type:
+ - name is an interned string such as 'CYPHER_AST_IDENTIFIER'
+ - instanceof is a tuple of the names of all types the node type is an
+   instance of, in the order of pycypher_node_types, or NULL until the first
+   node of this type is seen
+*/
+typedef struct {
+  PyObject* name;
+  PyObject* instanceof;
+}
+pycypher_node_type_info_t;
+
+/* Intern the names of all node types. Has to be called after
+pycypher_init_node_types. Return -1 with an exception set on failure.
+*/
+int pycypher_init_node_type_info(void);
+
+/* Both functions return borrowed references. */
+PyObject* pycypher_node_type_name(const cypher_astnode_t*);
+PyObject* pycypher_node_type_instanceof(const cypher_astnode_t*);
+
+#endif
@@ -24,6 +24,11 @@ pycypher_node_type_t;
 extern pycypher_node_type_t* pycypher_node_types;
 extern size_t pycypher_node_types_len;
 
+/* Number of distinct values of cypher_astnode_type_t, used to size tables
+indexed by node type.
+*/
+#define PYCYPHER_NODE_TYPES_CAPACITY (1 << (8 * sizeof(cypher_astnode_type_t)))
+
 void pycypher_init_node_types(void);
 
 #endif
@@ -14,86 +14,403 @@
  */
 #include "parser.h"
 
-cypher_parse_result_t* pycypher_invoke_parser(const char* query) {
-  cypher_parse_result_t* parse_result;
-  cypher_parser_config_t* parser_config = cypher_parser_new_config();
-  if(parser_config == NULL)
-    return (cypher_parse_result_t *)PyErr_SetFromErrno(PyExc_OSError);
-
-  parse_result = cypher_uparse(
-    query, strlen(query), NULL, parser_config, /*flags*/0
+/* Parse the query without touching any Python state, so it's safe to call
+without holding the GIL. The config is shared and only read, so nothing but
+the result is allocated per call. Return NULL and set errno on failure.
+*/
+cypher_parse_result_t* pycypher_invoke_parser(
+  const pycypher_parser_options_t* options, const char* query, size_t length
+) {
+  uint64_t start = pycypher_stats_clock();
+  cypher_parse_result_t* result = cypher_uparse(
+    query, length, NULL, options->config, options->flags
   );
+  pycypher_stats_parsed(start, length);
+  return result;
+}
 
-  free(parser_config);
-  return parse_result;
+static bool pycypher_is_native(PyObject* cls) {
+  return PyType_Check(cls) &&
+    PyType_IsSubtype((PyTypeObject*)cls, &pycypher_AstNodeType);
 }
 
-const char* pycypher_build_ast_type(const cypher_astnode_t* src_ast) {
-  size_t i;
-  for(i=0; i<pycypher_node_types_len; ++i)
-    if(pycypher_node_types[i].node_type == cypher_astnode_type(src_ast))
-      return pycypher_node_types[i].name;
-  return "CYPHER_AST_UNKNOWN";
+PyObject* pycypher_build_node(
+  pycypher_build_ctx_t* ctx, PyObject* id, PyObject* type, PyObject* instanceof,
+  PyObject* children, PyObject* props, Py_ssize_t start, Py_ssize_t end,
+  Py_hash_t hash
+) {
+  PyObject* result;
+  pycypher_stats_add(PYCYPHER_STAT_NODES_BUILT, 1);
+  if(pycypher_is_native(ctx->cls)) {
+    result = pycypher_new_ast_node(
+      (PyTypeObject*)ctx->cls, id, type, instanceof, children, props, start,
+      end, ctx->index, hash, (Py_ssize_t)ctx->depth
+    );
+  } else {
+    uint64_t clock = pycypher_stats_clock();
+#if PY_VERSION_HEX >= 0x03090000
+    PyObject* args[9] = {
+      id, type, instanceof, children, props, NULL, NULL, ctx->index, NULL
+    };
+    result = NULL;
+    if((args[5] = PyLong_FromSsize_t(start)) != NULL &&
+        (args[6] = PyLong_FromSsize_t(end)) != NULL &&
+        (args[8] = PyLong_FromSsize_t((Py_ssize_t)hash)) != NULL)
+      result = PyObject_Vectorcall(ctx->cls, args, 9, NULL);
+    Py_XDECREF(args[5]);
+    Py_XDECREF(args[6]);
+    Py_XDECREF(args[8]);
+    Py_DECREF(children);
+    Py_DECREF(props);
+#else
+    PyObject* arglist = Py_BuildValue(
+      "(OOONNnnOn)", id, type, instanceof, children, props, start, end,
+      ctx->index, (Py_ssize_t)hash
+    );
+    if(arglist == NULL)
+      return NULL;
+    result = PyObject_CallObject(ctx->cls, arglist);
+    Py_DECREF(arglist);
+#endif
+    pycypher_stats_add_time(PYCYPHER_STAT_INIT_NS, clock);
+  }
+  return pycypher_stats_allocated(result);
+}
+
+/* Return a borrowed reference to the node built for src_target in the subtree
+of node, built for src_ast, or NULL if it isn't there. The children of the
+built nodes are in the order of the children of their sources.
+*/
+static PyObject* pycypher_find_built_descendant(
+  PyObject* node, const cypher_astnode_t* src_ast,
+  const cypher_astnode_t* src_target
+) {
+  if(src_ast == src_target)
+    return node;
+  if(!PyObject_TypeCheck(node, &pycypher_AstNodeType))
+    return NULL;
+  PyObject* children = ((pycypher_AstNode*)node)->children;
+  Py_ssize_t n = PyTuple_GET_SIZE(children);
+  Py_ssize_t i;
+  for(i=0; i<n; ++i) {
+    PyObject* result = pycypher_find_built_descendant(
+      PyTuple_GET_ITEM(children, i), cypher_astnode_get_child(src_ast, i),
+      src_target
+    );
+    if(result != NULL)
+      return result;
+  }
+  return NULL;
+}
+
+Py_ssize_t pycypher_find_child(
+  const cypher_astnode_t* src_ast, Py_ssize_t n,
+  const cypher_astnode_t* src_child, Py_ssize_t* cursor
+) {
+  Py_ssize_t k;
+  for(k=0; k<n; ++k) {
+    Py_ssize_t i = *cursor + k < n ? *cursor + k : *cursor + k - n;
+    if(cypher_astnode_get_child(src_ast, i) == src_child) {
+      *cursor = i + 1;
+      return i;
+    }
+  }
+  return -1;
 }
 
-PyObject* pycypher_build_ast_instanceof(const cypher_astnode_t* src_ast) {
-  PyObject* result = PyList_New(0);
+int pycypher_visit_ast_props(
+  const cypher_astnode_t* src_ast, pycypher_ast_prop_visitor_t visit,
+  void* data
+) {
+  const pycypher_prop_plan_t* plan = pycypher_get_prop_plan(src_ast);
+  if(plan == NULL) {
+    PyErr_NoMemory();
+    return -1;
+  }
   size_t i;
-  for(i=0; i<pycypher_node_types_len; ++i)
-    if(cypher_astnode_instanceof(src_ast, pycypher_node_types[i].node_type)) {
-      PyObject* tmp = Py_BuildValue("s", pycypher_node_types[i].name);
-      PyList_Append(result, tmp);
-      Py_DECREF(tmp);
+  unsigned int j;
+  for(i=0; i<plan->len; ++i) {
+    const pycypher_prop_ref_t* ref = &plan->refs[i];
+    PyObject* role = pycypher_prop_ref_role(ref);
+    if(ref->kind == PYCYPHER_AST_PROP) {
+      const pycypher_ast_prop_t* prop = ref->prop;
+      const cypher_astnode_t* target = prop->getter(src_ast);
+      if(target != NULL && visit(data, target, role) < 0)
+        return -1;
+    } else if(ref->kind == PYCYPHER_AST_LIST_PROP) {
+      const pycypher_ast_list_prop_t* prop = ref->prop;
+      unsigned int n = prop->length_getter(src_ast);
+      for(j=0; j<n; ++j) {
+        const cypher_astnode_t* target = prop->list_getter(src_ast, j);
+        if(target != NULL && visit(data, target, role) < 0)
+          return -1;
+      }
+    } else if(ref->kind == PYCYPHER_AST_LIST_PLUS_ONE_PROP) {
+      const pycypher_ast_list_plus_one_prop_t* prop = ref->prop;
+      unsigned int n = prop->length_getter(src_ast) + 1;
+      for(j=0; j<n; ++j) {
+        const cypher_astnode_t* target = prop->list_getter(src_ast, j);
+        if(target != NULL && visit(data, target, role) < 0)
+          return -1;
+      }
     }
+  }
+  return 0;
+}
+
+typedef struct {
+  pycypher_AstNode* node;
+  const cypher_astnode_t* src_ast;
+  Py_ssize_t cursor;
+}
+pycypher_role_adder_t;
+
+/* Give the node built for src_child the role. Some props refer to deeper
+descendants than children, like the elements of the pattern path of a named
+path, which are then searched for in the whole subtree.
+*/
+static int pycypher_add_child_role(
+  void* data, const cypher_astnode_t* src_child, PyObject* role
+) {
+  pycypher_role_adder_t* adder = data;
+  pycypher_AstNode* node = adder->node;
+  const cypher_astnode_t* src_ast = adder->src_ast;
+  Py_ssize_t n = PyTuple_GET_SIZE(node->children);
+  Py_ssize_t i = pycypher_find_child(src_ast, n, src_child, &adder->cursor);
+  if(i >= 0)
+    return pycypher_add_role(node, PyTuple_GET_ITEM(node->children, i), role);
+  Py_ssize_t k;
+  for(k=0; k<n; ++k) {
+    PyObject* descendant = pycypher_find_built_descendant(
+      PyTuple_GET_ITEM(node->children, k), cypher_astnode_get_child(src_ast, k),
+      src_child
+    );
+    if(descendant != NULL)
+      return pycypher_add_role(node, descendant, role);
+  }
+  PyErr_SetString(PyExc_ValueError, "Node referred to by a prop not found.");
+  return -1;
+}
+
+/* Give the children of the native node built for src_ast the roles in which
+the AST props of src_ast refer to them, without going through the {"id",
+"role"} dicts of pycypher_extract_props.
+*/
+static int pycypher_add_child_roles(
+  pycypher_AstNode* node, const cypher_astnode_t* src_ast
+) {
+  pycypher_role_adder_t adder = {node, src_ast, 0};
+  return pycypher_visit_ast_props(src_ast, pycypher_add_child_role, &adder);
+}
+
+typedef struct {
+  const cypher_astnode_t* src_ast;
+  Py_ssize_t nchildren;
+  uint64_t* roles;
+  Py_ssize_t cursor;
+}
+pycypher_role_hasher_t;
+
+static int pycypher_hash_child_role(
+  void* data, const cypher_astnode_t* src_child, PyObject* role
+) {
+  pycypher_role_hasher_t* hasher = data;
+  Py_ssize_t i = pycypher_find_child(
+    hasher->src_ast, hasher->nchildren, src_child, &hasher->cursor
+  );
+  return i < 0 ? 0 : pycypher_hash_role(&hasher->roles[i], role);
+}
+
+/* Set roles[i] to the hash of the roles src_ast gives its i-th child, see
+pycypher_hash_role.
+*/
+static int pycypher_hash_child_roles(
+  const cypher_astnode_t* src_ast, Py_ssize_t nchildren, uint64_t* roles
+) {
+  pycypher_role_hasher_t hasher = {src_ast, nchildren, roles, 0};
+  memset(roles, 0, nchildren * sizeof(*roles));
+  return pycypher_visit_ast_props(src_ast, pycypher_hash_child_role, &hasher);
+}
+
+static PyObject* pycypher_build_native_node(
+  pycypher_build_ctx_t* ctx, const cypher_astnode_t* src_ast, PyObject* id,
+  PyObject* instanceof, PyObject* children, PyObject* props, Py_hash_t hash
+) {
+  pycypher_stats_add(PYCYPHER_STAT_NODES_BUILT, 1);
+  struct cypher_input_range range = cypher_astnode_range(src_ast);
+  PyObject* result = pycypher_stats_allocated(pycypher_new_ast_node(
+    (PyTypeObject*)ctx->cls, id, pycypher_node_type_name(src_ast), instanceof,
+    children, props, range.start.offset, range.end.offset, NULL, hash,
+    (Py_ssize_t)ctx->depth
+  ));
+  if(result != NULL &&
+      pycypher_add_child_roles((pycypher_AstNode*)result, src_ast) < 0)
+    Py_CLEAR(result);
   return result;
 }
 
-PyObject* pycypher_build_ast_children(PyObject* cls, const cypher_astnode_t* src_ast) {
+static PyObject* pycypher_build_hashed_ast(
+  pycypher_build_ctx_t* ctx, const cypher_astnode_t* src_ast, Py_hash_t* hash
+);
+
+/* Build a tuple of the children of the node, folding their structural hashes
+and roles into *children_hash.
+*/
+static PyObject* pycypher_build_ast_children(
+  pycypher_build_ctx_t* ctx, const cypher_astnode_t* src_ast,
+  uint64_t* children_hash
+) {
   int nchildren = cypher_astnode_nchildren(src_ast);
-  PyObject* result = PyList_New(nchildren);
+  PyObject* result = pycypher_stats_allocated(PyTuple_New(nchildren));
+  if(result == NULL)
+    return NULL;
+  if(nchildren == 0)
+    return result;
+  uint64_t* roles = malloc(nchildren * sizeof(*roles));
+  if(roles == NULL) {
+    Py_DECREF(result);
+    return PyErr_NoMemory();
+  }
+  if(pycypher_hash_child_roles(src_ast, nchildren, roles) < 0) {
+    free(roles);
+    Py_DECREF(result);
+    return NULL;
+  }
   int i;
   for(i=0; i<nchildren; ++i) {
-    PyObject* ast = pycypher_build_ast(cls, cypher_astnode_get_child(src_ast, i));
-    if(ast == NULL)
+    Py_hash_t child_hash;
+    PyObject* ast = pycypher_build_hashed_ast(
+      ctx, cypher_astnode_get_child(src_ast, i), &child_hash
+    );
+    if(ast == NULL) {
+      free(roles);
+      Py_DECREF(result);
       return NULL;
-    // PyList_SetItem consumes a reference so no need to call Py_DECREF(ast)
-    PyList_SetItem(result, i, ast);
+    }
+    PyTuple_SET_ITEM(result, i, ast);
+    *children_hash = pycypher_hash_child(*children_hash, child_hash, roles[i]);
   }
+  free(roles);
   return result;
 }
 
-PyObject* pycypher_build_ast(PyObject* cls, const cypher_astnode_t* src_ast) {
-  PyObject* arglist = Py_BuildValue(
-    "(isNNNii)", src_ast,
-    pycypher_build_ast_type(src_ast),
-    pycypher_build_ast_instanceof(src_ast),
-    pycypher_build_ast_children(cls, src_ast),
-    pycypher_extract_props(src_ast),
-    cypher_astnode_range(src_ast).start.offset,
-    cypher_astnode_range(src_ast).end.offset
-  );
-  if(arglist == NULL)
+/* Nodes of native classes only get their value props, as AST props are
+turned into roles right away. Other classes get all props, as documented for
+CypherAstNode.__init__.
+*/
+static PyObject* pycypher_build_hashed_ast(
+  pycypher_build_ctx_t* ctx, const cypher_astnode_t* src_ast, Py_hash_t* hash
+) {
+  bool native = pycypher_is_native(ctx->cls);
+  PyObject* instanceof = pycypher_node_type_instanceof(src_ast);
+  if(instanceof == NULL)
     return NULL;
-  PyObject* result = PyEval_CallObject(cls, arglist);
-  Py_DECREF(arglist);
+  size_t ordinal = ctx->next_ordinal++;
+  uint64_t children_hash = PYCYPHER_HASH_SEED;
+  ++ctx->depth;
+  PyObject* children = pycypher_build_ast_children(ctx, src_ast, &children_hash);
+  --ctx->depth;
+  if(children == NULL)
+    return NULL;
+  PyObject* props = NULL;
+  if((native
+        ? pycypher_extract_value_props(src_ast, &props) < 0
+        : (props = pycypher_extract_props(src_ast, ctx->ordinals)) == NULL) ||
+      pycypher_hash_node(
+        children_hash, PyTuple_GET_SIZE(children),
+        pycypher_node_type_name(src_ast), props, hash
+      ) < 0) {
+    Py_DECREF(children);
+    Py_XDECREF(props);
+    return NULL;
+  }
+  PyObject* id = PyLong_FromSize_t(ordinal);
+  if(id == NULL) {
+    Py_DECREF(children);
+    Py_XDECREF(props);
+    return NULL;
+  }
+  PyObject* result = native
+    ? pycypher_build_native_node(
+        ctx, src_ast, id, instanceof, children, props, *hash
+      )
+    : pycypher_build_node(
+        ctx, id, pycypher_node_type_name(src_ast), instanceof, children,
+        props, cypher_astnode_range(src_ast).start.offset,
+        cypher_astnode_range(src_ast).end.offset, *hash
+      );
+  Py_DECREF(id);
+  return result;
+}
+
+size_t pycypher_count_nodes(const cypher_astnode_t* src_ast) {
+  unsigned int nchildren = cypher_astnode_nchildren(src_ast);
+  size_t result = 1;
+  unsigned int i;
+  for(i=0; i<nchildren; ++i)
+    result += pycypher_count_nodes(cypher_astnode_get_child(src_ast, i));
+  return result;
+}
+
+void pycypher_put_ordinals(
+  pycypher_ptr_map_t* ordinals, const cypher_astnode_t* src_ast,
+  size_t* next_ordinal
+) {
+  unsigned int nchildren = cypher_astnode_nchildren(src_ast);
+  unsigned int i;
+  pycypher_ptr_map_put(ordinals, src_ast, (*next_ordinal)++);
+  for(i=0; i<nchildren; ++i)
+    pycypher_put_ordinals(
+      ordinals, cypher_astnode_get_child(src_ast, i), next_ordinal
+    );
+}
+
+PyObject* pycypher_build_ast(
+  pycypher_build_ctx_t* ctx, const cypher_astnode_t* src_ast
+) {
+  Py_hash_t hash;
+  uint64_t start = pycypher_stats_clock();
+  PyObject* result;
+  if(pycypher_is_native(ctx->cls)) {
+    result = pycypher_build_hashed_ast(ctx, src_ast, &hash);
+  } else {
+    // Props refer to nodes by id, which only the nodes of the same root
+    // need.
+    pycypher_ptr_map_t ordinals;
+    size_t next_ordinal = ctx->next_ordinal;
+    if(pycypher_ptr_map_init(&ordinals, pycypher_count_nodes(src_ast)) < 0)
+      return PyErr_NoMemory();
+    pycypher_put_ordinals(&ordinals, src_ast, &next_ordinal);
+    ctx->ordinals = &ordinals;
+    result = pycypher_build_hashed_ast(ctx, src_ast, &hash);
+    ctx->ordinals = NULL;
+    pycypher_ptr_map_free(&ordinals);
+  }
+  pycypher_stats_add_time(PYCYPHER_STAT_BUILD_NS, start);
+  pycypher_stats_add(PYCYPHER_STAT_BUILDS, 1);
   return result;
 }
 
 PyObject* pycypher_build_ast_list(
   PyObject* cls, const cypher_parse_result_t* parse_result
 ) {
+  pycypher_build_ctx_t ctx = {cls, PyDict_New()};
+  if(ctx.index == NULL)
+    return NULL;
   int nroots = cypher_parse_result_nroots(parse_result);
   PyObject* result = PyList_New(nroots);
   int i;
-  for(i=0; i<nroots; ++i) {
-    PyObject* ast = pycypher_build_ast(cls, cypher_parse_result_get_root(
+  for(i=0; result != NULL && i<nroots; ++i) {
+    PyObject* ast = pycypher_build_ast(&ctx, cypher_parse_result_get_root(
       parse_result, i
     ));
     if(ast == NULL)
-      return NULL;
-    // PyList_SetItem consumes a reference so no need to call Py_DECREF(ast)
-    PyList_SetItem(result, i, ast);
+      Py_CLEAR(result);
+    else
+      // PyList_SetItem consumes a reference so no need to call Py_DECREF(ast)
+      PyList_SetItem(result, i, ast);
   }
+  Py_DECREF(ctx.index);
   return result;
 }
 
@@ -107,7 +424,8 @@ PyObject* pycypher_build_exn(PyObject* cls, const cypher_parse_error_t* err) {
   );
   if(arglist == NULL)
     return NULL;
-  PyObject* result = PyEval_CallObject(cls, arglist);
+  pycypher_stats_add(PYCYPHER_STAT_ERRORS_BUILT, 1);
+  PyObject* result = PyObject_CallObject(cls, arglist);
   Py_DECREF(arglist);
   return result;
 }
@@ -130,17 +448,297 @@ PyObject* pycypher_build_exn_list(
   return result;
 }
 
+PyObject* pycypher_build_parse_result(
+  PyObject* ast_class, PyObject* exn_class, cypher_parse_result_t* parse_result
+) {
+  PyObject* ast_list = pycypher_build_ast_list(ast_class, parse_result);
+  PyObject* exn_list = pycypher_build_exn_list(exn_class, parse_result);
+  cypher_parse_result_free(parse_result);
+  return Py_BuildValue("(NN)", ast_list, exn_list);
+}
+
 PyObject* pycypher_parse_query(PyObject* self, PyObject* args) {
   char* query;
   PyObject* ast_class;
   PyObject* exn_class;
   if (!PyArg_ParseTuple(args, "OOs:parse", &ast_class, &exn_class, &query))
     return NULL;
-  cypher_parse_result_t* parse_result = pycypher_invoke_parser(query);
+  const pycypher_parser_options_t* options = pycypher_parser_options(self);
+  cypher_parse_result_t* parse_result;
+  Py_BEGIN_ALLOW_THREADS
+  parse_result = pycypher_invoke_parser(options, query, strlen(query));
+  Py_END_ALLOW_THREADS
+  if(parse_result == NULL)
+    return PyErr_SetFromErrno(PyExc_OSError);
+  return pycypher_build_parse_result(ast_class, exn_class, parse_result);
+}
+
+PyObject* pycypher_validate_query(PyObject* self, PyObject* args) {
+  char* query;
+  PyObject* exn_class;
+  if (!PyArg_ParseTuple(args, "Os:validate", &exn_class, &query))
+    return NULL;
+  const pycypher_parser_options_t* options = pycypher_parser_options(self);
+  cypher_parse_result_t* parse_result;
+  Py_BEGIN_ALLOW_THREADS
+  parse_result = pycypher_invoke_parser(options, query, strlen(query));
+  Py_END_ALLOW_THREADS
   if(parse_result == NULL)
     return PyErr_SetFromErrno(PyExc_OSError);
-  PyObject* ast_list = pycypher_build_ast_list(ast_class, parse_result);
   PyObject* exn_list = pycypher_build_exn_list(exn_class, parse_result);
-  cypher_parse_result_free((cypher_parse_result_t*) parse_result);
-  return Py_BuildValue("(NN)", ast_list, exn_list);
+  PyObject* result = exn_list == NULL ? NULL : Py_BuildValue(
+    "(NII)", exn_list,
+    cypher_parse_result_nnodes(parse_result),
+    cypher_parse_result_ndirectives(parse_result)
+  );
+  cypher_parse_result_free(parse_result);
+  return result;
+}
+
+#if PY_MAJOR_VERSION >= 3
+  #define PYCYPHER_BUFFER_FORMAT "y*"
+#else
+  #define PYCYPHER_BUFFER_FORMAT "s*"
+#endif
+
+PyObject* pycypher_parse_buffer(PyObject* self, PyObject* args) {
+  Py_buffer query;
+  PyObject* ast_class;
+  PyObject* exn_class;
+  if (!PyArg_ParseTuple(
+      args, "OO" PYCYPHER_BUFFER_FORMAT ":parse_buffer",
+      &ast_class, &exn_class, &query
+  ))
+    return NULL;
+  const pycypher_parser_options_t* options = pycypher_parser_options(self);
+  cypher_parse_result_t* parse_result;
+  // The buffer stays exported, and so can't be resized, until released.
+  Py_BEGIN_ALLOW_THREADS
+  parse_result = pycypher_invoke_parser(options, query.buf, query.len);
+  Py_END_ALLOW_THREADS
+  PyBuffer_Release(&query);
+  if(parse_result == NULL)
+    return PyErr_SetFromErrno(PyExc_OSError);
+  return pycypher_build_parse_result(ast_class, exn_class, parse_result);
+}
+
+/* Parse the whole file behind the descriptor, mapping it into memory when
+possible and reading it through cypher_fparse otherwise (pipes, empty files).
+Either way parsing starts at the beginning of the file, whatever the position
+of the descriptor, which is left as is. Pipes can't seek, so what is left in
+them is parsed. The descriptor isn't closed. Doesn't need the GIL.
+*/
+cypher_parse_result_t* pycypher_invoke_file_parser(
+  const pycypher_parser_options_t* options, int fd
+) {
+  struct stat st;
+  if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data != MAP_FAILED) {
+      cypher_parse_result_t* parse_result = pycypher_invoke_parser(
+        options, data, st.st_size
+      );
+      int error = errno;
+      munmap(data, st.st_size);
+      errno = error;
+      return parse_result;
+    }
+  }
+
+  cypher_parse_result_t* parse_result = NULL;
+  // The duplicate shares the position: rewind it to parse the whole file,
+  // like the mapping does, and restore it afterwards.
+  off_t position = lseek(fd, 0, SEEK_CUR);
+  if(position > 0 && lseek(fd, 0, SEEK_SET) < 0)
+    return NULL;
+  int dup_fd = dup(fd);
+  FILE* stream = dup_fd < 0 ? NULL : fdopen(dup_fd, "r");
+  if(stream == NULL) {
+    int error = errno;
+    if(dup_fd >= 0)
+      close(dup_fd);
+    if(position > 0)
+      lseek(fd, position, SEEK_SET);
+    errno = error;
+    return NULL;
+  }
+  uint64_t start = pycypher_stats_clock();
+  parse_result = cypher_fparse(stream, NULL, options->config, options->flags);
+  int error = errno;
+  // The number of bytes read from a stream isn't known.
+  pycypher_stats_parsed(start, 0);
+  fclose(stream);
+  if(position > 0)
+    lseek(fd, position, SEEK_SET);
+  errno = error;
+  return parse_result;
+}
+
+PyObject* pycypher_parse_fd(PyObject* self, PyObject* args) {
+  int fd;
+  PyObject* ast_class;
+  PyObject* exn_class;
+  if (!PyArg_ParseTuple(args, "OOi:parse_fd", &ast_class, &exn_class, &fd))
+    return NULL;
+  const pycypher_parser_options_t* options = pycypher_parser_options(self);
+  cypher_parse_result_t* parse_result;
+  Py_BEGIN_ALLOW_THREADS
+  parse_result = pycypher_invoke_file_parser(options, fd);
+  Py_END_ALLOW_THREADS
+  if(parse_result == NULL)
+    return PyErr_SetFromErrno(PyExc_OSError);
+  return pycypher_build_parse_result(ast_class, exn_class, parse_result);
+}
+
+typedef struct {
+  const char* query;
+  size_t length;
+  cypher_parse_result_t* parse_result;
+  int error;
+}
+pycypher_batch_item_t;
+
+typedef struct {
+  pycypher_batch_item_t* items;
+  size_t nitems;
+  size_t next_item;
+  pthread_mutex_t lock;
+  const pycypher_parser_options_t* options;
+}
+pycypher_batch_t;
+
+static void* pycypher_batch_worker(void* arg) {
+  pycypher_batch_t* batch = arg;
+  for(;;) {
+    size_t i;
+    pthread_mutex_lock(&batch->lock);
+    i = batch->next_item++;
+    pthread_mutex_unlock(&batch->lock);
+    if(i >= batch->nitems)
+      break;
+    batch->items[i].parse_result = pycypher_invoke_parser(
+      batch->options, batch->items[i].query, batch->items[i].length
+    );
+    if(batch->items[i].parse_result == NULL)
+      batch->items[i].error = errno;
+  }
+  return NULL;
+}
+
+/* Parse all items of the batch using up to nworkers threads, the calling
+thread being one of them. Has to be called without holding the GIL.
+*/
+static void pycypher_run_batch(pycypher_batch_t* batch, size_t nworkers) {
+  pthread_t* threads = NULL;
+  size_t nthreads = 0;
+  size_t i;
+  if(nworkers > batch->nitems)
+    nworkers = batch->nitems;
+  if(nworkers > 1)
+    threads = malloc((nworkers - 1) * sizeof(pthread_t));
+  if(threads != NULL)
+    for(i=0; i<nworkers-1; ++i) {
+      if(pthread_create(&threads[nthreads], NULL, pycypher_batch_worker, batch))
+        // Carry on with the threads we've got, in the worst case the calling
+        // thread parses the whole batch on its own.
+        break;
+      ++nthreads;
+    }
+  pycypher_batch_worker(batch);
+  for(i=0; i<nthreads; ++i)
+    pthread_join(threads[i], NULL);
+  free(threads);
+}
+
+static size_t pycypher_default_workers(void) {
+  long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+  return ncpus > 0 ? (size_t)ncpus : 1;
+}
+
+static int pycypher_get_query_buffer(
+  PyObject* query, const char** buffer, size_t* length
+) {
+  Py_ssize_t size;
+#if PY_MAJOR_VERSION >= 3
+  *buffer = PyUnicode_AsUTF8AndSize(query, &size);
+  if(*buffer == NULL)
+    return -1;
+#else
+  char* tmp;
+  if(PyString_AsStringAndSize(query, &tmp, &size) < 0)
+    return -1;
+  *buffer = tmp;
+#endif
+  *length = size;
+  return 0;
+}
+
+PyObject* pycypher_parse_queries(PyObject* self, PyObject* args) {
+  PyObject* ast_class;
+  PyObject* exn_class;
+  PyObject* queries;
+  int workers;
+  if (!PyArg_ParseTuple(
+      args, "OOOi:parse_queries", &ast_class, &exn_class, &queries, &workers
+  ))
+    return NULL;
+  // A snapshot of the queries keeps the strings, and so their buffers,
+  // alive while they are being parsed, even if the caller's list changes
+  // meanwhile.
+  PyObject* seq = PySequence_Tuple(queries);
+  if(seq == NULL)
+    return NULL;
+  pycypher_batch_t batch;
+  batch.nitems = PyTuple_GET_SIZE(seq);
+  batch.next_item = 0;
+  batch.options = pycypher_parser_options(self);
+  batch.items = calloc(batch.nitems ? batch.nitems : 1, sizeof(pycypher_batch_item_t));
+  if(batch.items == NULL) {
+    Py_DECREF(seq);
+    return PyErr_NoMemory();
+  }
+  size_t i;
+  for(i=0; i<batch.nitems; ++i)
+    if(pycypher_get_query_buffer(
+        PyTuple_GET_ITEM(seq, i),
+        &batch.items[i].query, &batch.items[i].length
+    ) < 0) {
+      free(batch.items);
+      Py_DECREF(seq);
+      return NULL;
+    }
+
+  pthread_mutex_init(&batch.lock, NULL);
+  Py_BEGIN_ALLOW_THREADS
+  pycypher_run_batch(
+    &batch, workers > 0 ? (size_t)workers : pycypher_default_workers()
+  );
+  Py_END_ALLOW_THREADS
+  pthread_mutex_destroy(&batch.lock);
+
+  PyObject* result = PyList_New(batch.nitems);
+  for(i=0; i<batch.nitems; ++i) {
+    PyObject* item = NULL;
+    if(result != NULL) {
+      if(batch.items[i].parse_result == NULL) {
+        errno = batch.items[i].error;
+        PyErr_SetFromErrno(PyExc_OSError);
+      } else {
+        item = pycypher_build_parse_result(
+          ast_class, exn_class, batch.items[i].parse_result
+        );
+        batch.items[i].parse_result = NULL;
+      }
+      if(item == NULL)
+        Py_CLEAR(result);
+      else
+        // PyList_SetItem consumes a reference so no need to call Py_DECREF
+        PyList_SetItem(result, i, item);
+    }
+    if(batch.items[i].parse_result != NULL)
+      cypher_parse_result_free(batch.items[i].parse_result);
+  }
+  free(batch.items);
+  Py_DECREF(seq);
+  return result;
 }
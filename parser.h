@@ -15,14 +15,102 @@
 #ifndef PYCYPHER_PARSER_H
 #define PYCYPHER_PARSER_H
 #include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <Python.h>
 #include <methodobject.h>
 #include <cypher-parser.h>
 #include "node_types.h"
+#include "node_type_info.h"
 #include "extract_props.h"
+#include "parser_options.h"
+#include "structural_hash.h"
+#include "stats.h"
+#include "ast_node.h"
+#include "ptr_map.h"
 
+/* Both functions parse with the given options and don't need the GIL. */
+cypher_parse_result_t* pycypher_invoke_parser(
+  const pycypher_parser_options_t*, const char*, size_t
+);
+cypher_parse_result_t* pycypher_invoke_file_parser(
+  const pycypher_parser_options_t*, int fd
+);
+PyObject* pycypher_build_exn(PyObject* cls, const cypher_parse_error_t*);
+PyObject* pycypher_build_exn_list(
+  PyObject* cls, const cypher_parse_result_t* parse_result
+);
 PyObject* pycypher_parse_query(PyObject*, PyObject*);
-PyObject* pycypher_build_ast(PyObject*, const cypher_astnode_t*);
+PyObject* pycypher_parse_queries(PyObject*, PyObject*);
+PyObject* pycypher_validate_query(PyObject*, PyObject*);
+PyObject* pycypher_parse_buffer(PyObject*, PyObject*);
+PyObject* pycypher_parse_fd(PyObject*, PyObject*);
+/* State shared while converting all nodes of a single parse result:
+ - cls is the class instantiated for every node, directly if it's a subtype
+   of pycypher_AstNodeType and by calling it otherwise
+ - index is a dict from which the nodes look up the nodes their props refer
+   to, see CypherAstNode.__init__
+ - next_ordinal is the id of the next node, nodes being numbered densely in
+   pre-order across all roots of the parse result
+ - depth is the depth of the node being built, 0 for roots
+ - ordinals holds the ids of the nodes of the root being built when they go
+   into props, for classes other than native ones
+Fields other than cls and index start at zero.
+*/
+typedef struct {
+  PyObject* cls;
+  PyObject* index;
+  size_t next_ordinal;
+  size_t depth;
+  pycypher_ptr_map_t* ordinals;
+}
+pycypher_build_ctx_t;
+
+/* Return the index of src_child among the n children of src_ast, looking from
+*cursor on since AST props mostly refer to children in order, or -1 if it
+isn't a child.
+*/
+Py_ssize_t pycypher_find_child(
+  const cypher_astnode_t* src_ast, Py_ssize_t n,
+  const cypher_astnode_t* src_child, Py_ssize_t* cursor
+);
+
+typedef int (*pycypher_ast_prop_visitor_t)(
+  void* data, const cypher_astnode_t* src_target, PyObject* role
+);
+
+/* Call visit for every node the AST props of src_ast refer to, in the order
+of the props, with the role they give it. Stop at the first negative return.
+*/
+int pycypher_visit_ast_props(
+  const cypher_astnode_t* src_ast, pycypher_ast_prop_visitor_t visit,
+  void* data
+);
+
+/* Return the number of nodes in the subtree. */
+size_t pycypher_count_nodes(const cypher_astnode_t*);
+
+/* Put the ordinal of every node of the subtree into ordinals, numbering them
+in pre-order from *next_ordinal on. These are the ids of the nodes built for
+them.
+*/
+void pycypher_put_ordinals(
+  pycypher_ptr_map_t* ordinals, const cypher_astnode_t*, size_t* next_ordinal
+);
+
+/* Return a new node of ctx->cls for a node with the given fields, stealing
+the references to children, a tuple, and props, at depth ctx->depth. See
+pycypher_AstNode.
+*/
+PyObject* pycypher_build_node(
+  pycypher_build_ctx_t* ctx, PyObject* id, PyObject* type, PyObject* instanceof,
+  PyObject* children, PyObject* props, Py_ssize_t start, Py_ssize_t end,
+  Py_hash_t hash
+);
+PyObject* pycypher_build_ast(pycypher_build_ctx_t*, const cypher_astnode_t*);
 PyObject* pycypher_build_ast_list(
   PyObject* cls, const cypher_parse_result_t* parse_result
 );
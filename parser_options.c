@@ -0,0 +1,198 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "parser_options.h"
+#include "parser.h"
+#include "lazy.h"
+#include "flat.h"
+#include "stream.h"
+
+static pycypher_parser_options_t pycypher_default_options;
+
+/* Set the options to those of a new config, which is NULL if out of memory. */
+static void pycypher_default_parser_options(
+  pycypher_parser_options_t* options, cypher_parser_config_t* config
+) {
+  struct cypher_input_position position = {1, 1, 0};
+  options->config = config;
+  options->flags = CYPHER_PARSE_DEFAULT;
+  options->initial_position = position;
+  options->error_colorization = cypher_parser_no_colorization;
+}
+
+const pycypher_parser_options_t* pycypher_parser_options(PyObject* self) {
+  // Module functions get the module as self on Python 3 and NULL on Python 2.
+  if(self != NULL && PyObject_TypeCheck(self, &pycypher_ParserType))
+    return &((pycypher_Parser*)self)->options;
+#if PY_MAJOR_VERSION >= 3
+  if(self != NULL && PyModule_Check(self)) {
+    pycypher_module_state_t* state = PyModule_GetState(self);
+    if(state != NULL && state->options.config != NULL)
+      return &state->options;
+  }
+#endif
+  return &pycypher_default_options;
+}
+
+static PyObject* pycypher_Parser_new(
+  PyTypeObject* type, PyObject* args, PyObject* kwargs
+) {
+  static char* kwlist[] = {
+    "only_statements", "single", "initial_offset", "initial_line",
+    "initial_column", "colorize_errors", NULL
+  };
+  PyObject* only_statements = Py_False;
+  PyObject* single = Py_False;
+  Py_ssize_t initial_offset = 0;
+  unsigned int initial_line = 1;
+  unsigned int initial_column = 1;
+  PyObject* colorize_errors = Py_False;
+  if(!PyArg_ParseTupleAndKeywords(
+      args, kwargs, "|OOnIIO:Parser", kwlist, &only_statements, &single,
+      &initial_offset, &initial_line, &initial_column, &colorize_errors
+  ))
+    return NULL;
+  if(initial_offset < 0) {
+    PyErr_SetString(PyExc_ValueError, "initial_offset must not be negative");
+    return NULL;
+  }
+
+  pycypher_Parser* self = (pycypher_Parser*)type->tp_alloc(type, 0);
+  if(self == NULL)
+    return NULL;
+  self->options.config = cypher_parser_new_config();
+  if(self->options.config == NULL) {
+    Py_DECREF(self);
+    return PyErr_NoMemory();
+  }
+  self->options.flags = CYPHER_PARSE_DEFAULT;
+  if(PyObject_IsTrue(only_statements))
+    self->options.flags |= CYPHER_PARSE_ONLY_STATEMENTS;
+  if(PyObject_IsTrue(single))
+    self->options.flags |= CYPHER_PARSE_SINGLE;
+  struct cypher_input_position position = {
+    initial_line, initial_column, initial_offset
+  };
+  self->options.initial_position = position;
+  self->options.error_colorization = PyObject_IsTrue(colorize_errors)
+    ? cypher_parser_ansi_colorization
+    : cypher_parser_no_colorization;
+  cypher_parser_config_set_initial_position(self->options.config, position);
+  cypher_parser_config_set_error_colorization(
+    self->options.config, self->options.error_colorization
+  );
+  return (PyObject*)self;
+}
+
+static void pycypher_Parser_dealloc(pycypher_Parser* self) {
+  if(self->options.config != NULL)
+    cypher_parser_config_free(self->options.config);
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyMethodDef pycypher_Parser_methods[] = {
+  {
+    "parse_query", pycypher_parse_query, METH_VARARGS,
+    "Like the module function, using the options of the parser."
+  },
+  {
+    "parse_queries", pycypher_parse_queries, METH_VARARGS,
+    "Like the module function, using the options of the parser."
+  },
+  {
+    "validate", pycypher_validate_query, METH_VARARGS,
+    "Like the module function, using the options of the parser."
+  },
+  {
+    "parse_buffer", pycypher_parse_buffer, METH_VARARGS,
+    "Like the module function, using the options of the parser."
+  },
+  {
+    "parse_fd", pycypher_parse_fd, METH_VARARGS,
+    "Like the module function, using the options of the parser."
+  },
+  {
+    "parse_query_lazy", pycypher_parse_query_lazy, METH_VARARGS,
+    "Like the module function, using the options of the parser."
+  },
+  {
+    "parse_query_flat", pycypher_parse_query_flat, METH_VARARGS,
+    "Like the module function, using the options of the parser."
+  },
+  {
+    "iter_buffer", pycypher_iter_buffer, METH_VARARGS,
+    "Like the module function, using the options of the parser."
+  },
+  {
+    "iter_fd", pycypher_iter_fd, METH_VARARGS,
+    "Like the module function, using the options of the parser."
+  },
+  {NULL}
+};
+
+PyTypeObject pycypher_ParserType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "pycypher.bindings.Parser",           /* tp_name */
+  sizeof(pycypher_Parser),              /* tp_basicsize */
+  0,                                    /* tp_itemsize */
+  (destructor)pycypher_Parser_dealloc,  /* tp_dealloc */
+};
+
+int pycypher_init_parser_options(PyObject* module) {
+  if(pycypher_default_options.config == NULL) {
+    pycypher_default_parser_options(
+      &pycypher_default_options, cypher_parser_new_config()
+    );
+    if(pycypher_default_options.config == NULL) {
+      PyErr_NoMemory();
+      return -1;
+    }
+  }
+  pycypher_ParserType.tp_flags = Py_TPFLAGS_DEFAULT;
+  pycypher_ParserType.tp_doc = "Parser options shared by all queries it parses.";
+  pycypher_ParserType.tp_new = pycypher_Parser_new;
+  pycypher_ParserType.tp_methods = pycypher_Parser_methods;
+  if(PyType_Ready(&pycypher_ParserType) < 0)
+    return -1;
+  Py_INCREF(&pycypher_ParserType);
+  if(PyModule_AddObject(module, "Parser", (PyObject*)&pycypher_ParserType) < 0) {
+    Py_DECREF(&pycypher_ParserType);
+    return -1;
+  }
+  return 0;
+}
+
+int pycypher_init_module_state(PyObject* module) {
+#if PY_MAJOR_VERSION >= 3
+  pycypher_module_state_t* state = PyModule_GetState(module);
+  if(state != NULL && state->options.config == NULL) {
+    pycypher_default_parser_options(&state->options, cypher_parser_new_config());
+    if(state->options.config == NULL) {
+      PyErr_NoMemory();
+      return -1;
+    }
+  }
+#endif
+  return 0;
+}
+
+void pycypher_free_module_state(PyObject* module) {
+#if PY_MAJOR_VERSION >= 3
+  pycypher_module_state_t* state = PyModule_GetState(module);
+  if(state != NULL && state->options.config != NULL) {
+    cypher_parser_config_free(state->options.config);
+    state->options.config = NULL;
+  }
+#endif
+}
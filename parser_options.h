@@ -0,0 +1,68 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_PARSER_OPTIONS_H
+#define PYCYPHER_PARSER_OPTIONS_H
+#include <stdint.h>
+#include <Python.h>
+#include <cypher-parser.h>
+
+/* A libcypher-parser config and flags, created once and then only read, so
+that parses running concurrently without the GIL can share them. The initial
+position and error colorization set in the config are kept alongside, for
+statement streams, which need a config of their own.
+*/
+typedef struct {
+  cypher_parser_config_t* config;
+  uint64_t flags;
+  struct cypher_input_position initial_position;
+  const struct cypher_parser_colorization* error_colorization;
+}
+pycypher_parser_options_t;
+
+/* A Parser exposes the module's parse functions as methods, all of which use
+the parser's options instead of the defaults.
+*/
+typedef struct {
+  PyObject_HEAD
+  pycypher_parser_options_t options;
+}
+pycypher_Parser;
+
+extern PyTypeObject pycypher_ParserType;
+
+/* State of each instance of the bindings module on Python 3, freed along
+with the module: the options of its parse functions.
+*/
+typedef struct {
+  pycypher_parser_options_t options;
+}
+pycypher_module_state_t;
+
+/* Create the default options, ready the Parser type and add it to the
+module. Return -1 on failure.
+*/
+int pycypher_init_parser_options(PyObject* module);
+
+/* Set up the state of the module, if it has any, and free it. */
+int pycypher_init_module_state(PyObject* module);
+void pycypher_free_module_state(PyObject* module);
+
+/* Return the options of self if it is a Parser, those of the module for
+module functions, and the process-wide defaults otherwise (e.g. for module
+functions on Python 2, which get no module).
+*/
+const pycypher_parser_options_t* pycypher_parser_options(PyObject* self);
+
+#endif
@@ -0,0 +1,71 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "ptr_map.h"
+
+static size_t pycypher_ptr_map_slot(const pycypher_ptr_map_t* map, const void* key) {
+  uint64_t hash = (uint64_t)(uintptr_t)key;
+  // Pointers are aligned, mix the high bits into the low ones.
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash & (map->capacity - 1);
+}
+
+int pycypher_ptr_map_init(pycypher_ptr_map_t* map, size_t nkeys) {
+  // Keep the load factor at or below 1/2, capacity being a power of two.
+  map->capacity = 16;
+  while(map->capacity < 2 * nkeys)
+    map->capacity *= 2;
+  map->keys = calloc(map->capacity, sizeof(*map->keys));
+  map->values = malloc(map->capacity * sizeof(*map->values));
+  if(map->keys == NULL || map->values == NULL) {
+    pycypher_ptr_map_free(map);
+    return -1;
+  }
+  return 0;
+}
+
+void pycypher_ptr_map_free(pycypher_ptr_map_t* map) {
+  free(map->keys);
+  free(map->values);
+  map->keys = NULL;
+  map->values = NULL;
+  map->capacity = 0;
+}
+
+void pycypher_ptr_map_put(pycypher_ptr_map_t* map, const void* key, size_t value) {
+  size_t slot = pycypher_ptr_map_slot(map, key);
+  while(map->keys[slot] != NULL && map->keys[slot] != key)
+    slot = (slot + 1) & (map->capacity - 1);
+  map->keys[slot] = key;
+  map->values[slot] = value;
+}
+
+bool pycypher_ptr_map_get(const pycypher_ptr_map_t* map, const void* key, size_t* value) {
+  size_t slot;
+  if(map->capacity == 0 || key == NULL)
+    return false;
+  slot = pycypher_ptr_map_slot(map, key);
+  while(map->keys[slot] != NULL) {
+    if(map->keys[slot] == key) {
+      *value = map->values[slot];
+      return true;
+    }
+    slot = (slot + 1) & (map->capacity - 1);
+  }
+  return false;
+}
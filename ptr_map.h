@@ -0,0 +1,37 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_PTR_MAP_H
+#define PYCYPHER_PTR_MAP_H
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Open addressing hash map from pointers (e.g. AST nodes) to size_t values,
+sized up front for a known number of keys. Doesn't touch any Python state.
+*/
+typedef struct {
+  const void** keys;
+  size_t* values;
+  size_t capacity;
+}
+pycypher_ptr_map_t;
+
+/* Return -1 when out of memory. */
+int pycypher_ptr_map_init(pycypher_ptr_map_t*, size_t nkeys);
+void pycypher_ptr_map_free(pycypher_ptr_map_t*);
+/* At most nkeys distinct keys may be put into the map. */
+void pycypher_ptr_map_put(pycypher_ptr_map_t*, const void* key, size_t value);
+bool pycypher_ptr_map_get(const pycypher_ptr_map_t*, const void* key, size_t* value);
+
+#endif
@@ -11,12 +11,30 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
-from .bindings import parse_query as inner_parse_query
-from .ast import CypherAstNode
+import bisect
+import collections
+import os
+
+from . import bindings
+from .bindings import iter_buffer as inner_iter_buffer
+from .bindings import dump_query as inner_dump_query
+from .bindings import load_query as inner_load_query
+from .bindings import fingerprint_query as inner_fingerprint_query
+from .ast import CypherAstNode, LazyCypherAstNode
+from .flat import FlatAst
+from .literals import Literals
+from .cache import ParseCache
 from .version import __version__
 
 
-__ALL__ = ['parse_query', 'CypherAstNode', 'CypherParseError']
+__ALL__ = [
+    'parse_query', 'parse_queries', 'parse_file', 'parse_buffer',
+    'iter_statements', 'iter_file', 'parse_query_flat', 'dump_query',
+    'load_query', 'fingerprint', 'set_cache_size', 'cache_info', 'validate',
+    'Validation', 'Parser', 'Matcher', 'Match', 'extract_literals',
+    'Literals', 'ParsedScript', 'enable_stats', 'stats', 'reset_stats',
+    'CypherAstNode', 'LazyCypherAstNode', 'FlatAst', 'CypherParseError',
+]
 
 
 class CypherParseError(Exception):
@@ -30,12 +48,539 @@ class CypherParseError(Exception):
         self.parse_result = None
 
 
-def parse_query(query):
-    result, errors = inner_parse_query(CypherAstNode, CypherParseError, query)
+def _first_error(result, errors):
+    e = errors[0]
+    e.all_errors = errors
+    e.parse_result = result
+    return e
+
+
+_cache = None
+
+
+def set_cache_size(maxsize):
+    """Cache the results of up to `maxsize` distinct successfully parsed
+    queries, or disable the cache if `maxsize` is 0 or None (the default).
+
+    When enabled, parse_query returns the same CypherAstNode instances for
+    every parse of the same query text, so they must not be modified.
+    """
+    global _cache
+    _cache = ParseCache(maxsize) if maxsize else None
+
+
+def cache_info():
+    """Return a CacheInfo of hits, misses, maxsize, currsize and the number of
+    distinct query fingerprints among the cached queries whose fingerprint has
+    been computed, or None if the cache is disabled.
+    """
+    cache = _cache
+    return cache.info() if cache is not None else None
+
+
+def enable_stats(enabled=True):
+    """Turn the counters and timers reported by stats on or off, and return
+    whether they were on. They are off by default and cost a few clock reads
+    per node built when on.
+    """
+    return bindings.enable_stats(enabled)
+
+
+def stats():
+    """Return a snapshot of the counters and timers of the bindings as a dict:
+
+    - parses, bytes_parsed, parse_ns: native parses (one per directive when
+      iterating over statements), the bytes of query text they were given
+      and the time they took
+    - builds, nodes_built, errors_built: CypherAstNode trees and nodes and
+      CypherParseError instances built from native results
+    - build_ns: the time taken by builds, of which init_ns was spent creating
+      the nodes themselves and convert_ns in the rest of the bindings. Only
+      CypherAstNode.__init__ of node classes not derived from the native
+      AstNode counts as init, so init_ns stays 0 for natively built nodes.
+    - objects_allocated: nodes and the props dicts, lists and tuples
+      allocated for them
+
+    Times are in nanoseconds of a monotonic clock. Counters accumulate across
+    threads and since the last reset_stats.
+    """
+    result = bindings.stats()
+    result['convert_ns'] = max(result['build_ns'] - result['init_ns'], 0)
+    return result
+
+
+def reset_stats():
+    bindings.reset_stats()
+
+
+def fingerprint(query):
+    """Return an integer identifying the shape of the query: node types, tree
+    structure, identifiers, labels, operators and so on, but not the values of
+    literals or the names of parameters. Raises CypherParseError if the query
+    doesn't parse.
+    """
+    cache = _cache
+    cached = cache.get(query, 1) if cache is not None else None
+    if cached is not None:
+        return cached
+    result, nerrors = inner_fingerprint_query(query)
+    if nerrors:
+        # Produce the same exception as parse_query would.
+        parse_query(query)
+    if cache is not None:
+        cache.put(query, None, result)
+    return result
+
+
+def parse_query(query, lazy=False):
+    """Return a list of CypherAstNode instances, one per root of the parsed
+    query, or raise CypherParseError.
+
+    With lazy=True the nodes are LazyCypherAstNode instances, which keep the
+    native parse result alive and only convert the parts of it that are
+    accessed. Lazy parses bypass the cache set up by set_cache_size.
+    """
+    cache = _cache
+    if cache is not None and not lazy:
+        cached = cache.get(query, 0)
+        if cached is not None:
+            return list(cached)
+    result = _parse_query(bindings, query, lazy)
+    if cache is not None and not lazy:
+        cache.put(query, result, None)
+        return list(result)
+    return result
+
+
+class Validation(collections.namedtuple(
+        'Validation', ['errors', 'nnodes', 'ndirectives'])):
+    """Outcome of validate: a list of CypherParseError, empty for valid
+    queries, and the number of AST nodes and directives the parser produced.
+    """
+    __slots__ = ()
+
+    @property
+    def valid(self):
+        return not self.errors
+
+
+def validate(query):
+    """Parse the query without building any CypherAstNode and return a
+    Validation. Never raises CypherParseError.
+    """
+    return _validate(bindings, query)
+
+
+def _validate(native, query):
+    return Validation(*native.validate(CypherParseError, query))
+
+
+def parse_buffer(buffer):
+    """Return a list of CypherAstNode instances for the UTF-8 encoded query
+    held by a bytes, bytearray, memoryview or other object supporting the
+    buffer protocol, or raise CypherParseError. The buffer is parsed in place,
+    with its full length, so NUL bytes don't end the query.
+    """
+    return _parse_buffer(bindings, buffer)
+
+
+def parse_file(file):
+    """Return a list of CypherAstNode instances for the whole content of a
+    file, given either as a path or as an object with a fileno() method, or
+    raise CypherParseError. Regular files are mapped into memory rather than
+    read into a Python string. Objects without a file descriptor, such as
+    io.BytesIO, are read and passed to parse_buffer. The whole content is
+    parsed whatever the position of the file, which is left as is, except for
+    pipes and other files that can't seek, whose remaining content is parsed.
+    """
+    return _parse_file(bindings, file)
+
+
+def _parse_query(native, query, lazy):
+    if lazy:
+        refs, errors = native.parse_query_lazy(CypherParseError, query)
+        result = [LazyCypherAstNode(ref) for ref in refs]
+    else:
+        result, errors = native.parse_query(
+            CypherAstNode, CypherParseError, query
+        )
+    if errors:
+        raise _first_error(result, errors)
+    else:
+        return result
+
+
+def _parse_buffer(native, buffer):
+    result, errors = native.parse_buffer(
+        CypherAstNode, CypherParseError, buffer
+    )
+    if errors:
+        raise _first_error(result, errors)
+    else:
+        return result
+
+
+def _parse_file(native, file):
+    if hasattr(file, 'fileno'):
+        try:
+            fd = file.fileno()
+        except (AttributeError, IOError, OSError, ValueError):
+            fd = None
+        if fd is None:
+            return _parse_buffer(native, _read_all(file))
+        result, errors = native.parse_fd(CypherAstNode, CypherParseError, fd)
+    else:
+        fd = os.open(file, os.O_RDONLY)
+        try:
+            result, errors = native.parse_fd(
+                CypherAstNode, CypherParseError, fd
+            )
+        finally:
+            os.close(fd)
+    if errors:
+        raise _first_error(result, errors)
+    else:
+        return result
+
+
+def iter_statements(query):
+    """Parse the query, a string or an object supporting the buffer protocol,
+    one directive at a time and yield an (ast, errors) tuple for each as soon
+    as it's parsed. ast is the CypherAstNode of the directive, or None if the
+    parser couldn't make out a directive, and errors a possibly empty list of
+    CypherParseError. Only a single directive is held in memory at a time.
+    """
+    return _iter_statements(bindings, query)
+
+
+def _iter_statements(native, query):
+    if not isinstance(query, (bytes, bytearray, memoryview)):
+        try:
+            query = query.encode('utf-8')
+        except AttributeError:
+            pass
+    return native.iter_buffer(CypherAstNode, CypherParseError, query)
+
+
+def iter_file(file):
+    """Like iter_statements, for the whole content of a file given either as
+    a path or as a file object, see parse_file. Regular files are mapped into
+    memory, others are read first.
+    """
+    return _iter_file(bindings, file)
+
+
+def _iter_file(native, file):
+    if not hasattr(file, 'fileno'):
+        fd = os.open(file, os.O_RDONLY)
+        try:
+            result = native.iter_fd(CypherAstNode, CypherParseError, fd)
+            if result is None:
+                with os.fdopen(os.dup(fd), 'rb') as f:
+                    result = _iter_statements(native, f.read())
+        finally:
+            os.close(fd)
+        return result
+    try:
+        fd = file.fileno()
+    except (AttributeError, IOError, OSError, ValueError):
+        fd = None
+    result = None
+    if fd is not None:
+        result = native.iter_fd(CypherAstNode, CypherParseError, fd)
+    if result is None:
+        result = _iter_statements(native, _read_all(file))
+    return result
+
+
+def _read_all(file):
+    # Read the whole content of a file object as bytes, leaving its position
+    # as is, like native parsers do with file descriptors.
+    seekable = hasattr(file, 'seekable') and file.seekable()
+    if seekable:
+        position = file.tell()
+        file.seek(0)
+    data = file.read()
+    if seekable:
+        file.seek(position)
+    if not isinstance(data, bytes):
+        data = data.encode('utf-8')
+    return data
+
+
+class ParsedScript(object):
+    """A script kept parsed across edits, for editors re-parsing their buffer
+    on every keystroke. The script is split into directives like
+    iter_statements does. An edit re-parses directives from the first one it
+    touches until the parse ends on a directive boundary of the previous
+    parse, behind which the text is unchanged. The directives after it are
+    kept along with their CypherAstNode trees, whose start and end are
+    shifted in place by the change in length when next accessed.
+
+    Offsets, in edits as in nodes and errors, count bytes of the UTF-8
+    encoded script.
+    """
+
+    def __init__(self, query):
+        if not isinstance(query, bytes):
+            query = query.encode('utf-8')
+        self._text = query
+        # Offset at which the part of the script holding each directive ends,
+        # including whatever precedes the next directive.
+        self._ends = []
+        # An [ast, errors, shift] list per directive, where shift is what its
+        # offsets have yet to be moved by.
+        self._segments = []
+        self._parse_from(0, [], [], 0)
+
+    @property
+    def text(self):
+        return self._text.decode('utf-8')
+
+    def directives(self):
+        """Return a list of (ast, errors) tuples, as yielded by
+        iter_statements for the current script.
+        """
+        return [self._settle(segment) for segment in self._segments]
+
+    @property
+    def asts(self):
+        return [ast for ast, _ in self.directives() if ast is not None]
+
+    @property
+    def errors(self):
+        return [e for _, errors in self.directives() for e in errors]
+
+    def edit(self, offset, deleted, inserted):
+        """Replace the deleted bytes at offset by inserted, a string or bytes,
+        and re-parse the directives affected. Return the number of directives
+        that were parsed again.
+        """
+        if not isinstance(inserted, bytes):
+            inserted = inserted.encode('utf-8')
+        if offset < 0 or deleted < 0 or offset + deleted > len(self._text):
+            raise ValueError('Edit out of range.')
+        self._text = (
+            self._text[:offset] + inserted + self._text[offset + deleted:]
+        )
+        first = bisect.bisect_left(self._ends, offset)
+        start = self._ends[first - 1] if first else 0
+        # Only directives ending behind the edit can be kept.
+        kept = bisect.bisect_left(self._ends, offset + deleted, first)
+        old_ends = self._ends[kept:]
+        old_segments = self._segments[kept:]
+        del self._ends[first:]
+        del self._segments[first:]
+        return self._parse_from(
+            start, old_ends, old_segments, len(inserted) - deleted
+        )
+
+    def _parse_from(self, start, old_ends, old_segments, shift):
+        line = self._text.count(b'\n', 0, start) + 1
+        column = start - self._text.rfind(b'\n', 0, start)
+        stream = inner_iter_buffer(
+            CypherAstNode, CypherParseError, self._text, start, line, column
+        )
+        nparsed = 0
+        i = 0
+        for ast, errors in stream:
+            nparsed += 1
+            end = stream.offset
+            self._ends.append(end)
+            self._segments.append([ast, errors, 0])
+            while i < len(old_ends) and old_ends[i] + shift < end:
+                i += 1
+            if i < len(old_ends) and old_ends[i] + shift == end:
+                for old_end, segment in zip(
+                    old_ends[i + 1:], old_segments[i + 1:]
+                ):
+                    self._ends.append(old_end + shift)
+                    segment[2] += shift
+                    self._segments.append(segment)
+                break
+        return nparsed
+
+    @staticmethod
+    def _settle(segment):
+        ast, errors, shift = segment
+        if shift:
+            if ast is not None:
+                for node in ast.find_nodes():
+                    node._start += shift
+                    node._end += shift
+            for e in errors:
+                e.offset += shift
+            segment[2] = 0
+        return ast, errors
+
+
+def parse_query_flat(query):
+    """Return the parsed query as a FlatAst, without creating any Python
+    objects per node, or raise CypherParseError.
+    """
+    return _parse_query_flat(bindings, query)
+
+
+def _parse_query_flat(native, query):
+    columns, errors = native.parse_query_flat(CypherParseError, query)
+    result = FlatAst(columns)
+    if errors:
+        raise _first_error(result, errors)
+    else:
+        return result
+
+
+def extract_literals(query, prefix='p'):
+    """Return the Literals of the query, including a template of it in which
+    literals are replaced by parameters named prefix0, prefix1 and so on, or
+    raise CypherParseError. No CypherAstNode is built. Choose a prefix not
+    used by the query's own parameters.
+    """
+    columns, errors = bindings.extract_literals(
+        CypherParseError, query, prefix
+    )
+    result = Literals(columns, prefix)
     if errors:
-        e = errors[0]
-        e.all_errors = errors
-        e.parse_result = result
-        raise e
+        raise _first_error(result, errors)
     else:
         return result
+
+
+def dump_query(query):
+    """Parse the query and return the result, including any parse errors, as
+    bytes that load_query turns back into CypherAstNode instances without
+    parsing the query again.
+    """
+    return inner_dump_query(query)
+
+
+def load_query(blob):
+    """Return what parse_query would return for the query dumped into the
+    blob by dump_query, or raise CypherParseError. Raises ValueError if the
+    blob is corrupt or of an unsupported version.
+    """
+    result, errors = inner_load_query(CypherAstNode, CypherParseError, blob)
+    if errors:
+        raise _first_error(result, errors)
+    else:
+        return result
+
+
+def parse_queries(queries, workers=None):
+    """Parse a sequence of queries on up to `workers` native threads (one per
+    CPU by default) and return a list with an entry per query, in input order.
+    Each entry is what parse_query would return for that query, or the
+    CypherParseError it would raise.
+    """
+    return _parse_queries(bindings, queries, workers)
+
+
+def _parse_queries(native, queries, workers):
+    results = native.parse_queries(
+        CypherAstNode, CypherParseError, queries, workers or 0
+    )
+    return [
+        _first_error(result, errors) if errors else result
+        for result, errors in results
+    ]
+
+
+Match = collections.namedtuple('Match', ['type', 'start', 'end'])
+
+
+class Matcher(object):
+    """A set of structural patterns compiled once and checked together in a
+    single native pass over each parsed query, without building any
+    CypherAstNode. Patterns look like CSS selectors over node types:
+
+        FOREACH >> LOAD_CSV
+        RETURN[!limit]
+        MATCH >> REL_PATTERN[direction=INBOUND] > RANGE[!end]
+        QUERY > *[@clause]
+
+    `>` requires the next step to be a child, `>>` any descendant. Types may
+    be given with or without the CYPHER_AST_ prefix and match by instanceof,
+    so EXPRESSION matches every expression, and `*` matches any node.
+    Conditions in brackets refer to prop and role names as used by the
+    getters: `prop` requires it to be set, `!prop` requires it not to be,
+    `prop=value` compares string, bool, operator and direction props and
+    `@role` requires the parent to refer to the node in that role.
+    """
+
+    def __init__(self, patterns):
+        self.patterns = list(patterns)
+        self._native = bindings.Matcher(self.patterns)
+
+    def match(self, query):
+        """Return a list with, for each pattern, the list of Match(type,
+        start, end) of the nodes it matches in pre-order, or raise
+        CypherParseError. See Parser.match for other parser options.
+        """
+        return _match(bindings, self, query)
+
+
+def _match(native, matcher, query):
+    matches, errors = matcher._native.match_query(
+        CypherParseError, query, native
+    )
+    result = [[Match(*m) for m in pattern] for pattern in matches]
+    if errors:
+        raise _first_error(result, errors)
+    else:
+        return result
+
+
+class Parser(object):
+    """Parses queries with fixed libcypher-parser options. The native config
+    is created once, when the parser is, and shared by all its parses.
+
+    - only_statements: skip comments and client commands, so only statements
+      and schema commands end up in the result
+    - single: stop after the first directive
+    - initial_offset, initial_line, initial_column: the position of the start
+      of each query, for queries taken from a larger input
+    - colorize_errors: use ANSI colors in the context of parse errors
+
+    The parse and iter methods behave like the module functions of the same
+    name, and match like Matcher.match. Results are never taken from or put
+    into the cache of parse_query.
+    """
+
+    def __init__(self, only_statements=False, single=False,
+                 initial_offset=0, initial_line=1, initial_column=1,
+                 colorize_errors=False):
+        self._native = bindings.Parser(
+            only_statements=only_statements,
+            single=single,
+            initial_offset=initial_offset,
+            initial_line=initial_line,
+            initial_column=initial_column,
+            colorize_errors=colorize_errors,
+        )
+
+    def parse_query(self, query, lazy=False):
+        return _parse_query(self._native, query, lazy)
+
+    def parse_queries(self, queries, workers=None):
+        return _parse_queries(self._native, queries, workers)
+
+    def validate(self, query):
+        return _validate(self._native, query)
+
+    def parse_buffer(self, buffer):
+        return _parse_buffer(self._native, buffer)
+
+    def parse_file(self, file):
+        return _parse_file(self._native, file)
+
+    def parse_query_flat(self, query):
+        return _parse_query_flat(self._native, query)
+
+    def iter_statements(self, query):
+        return _iter_statements(self._native, query)
+
+    def iter_file(self, file):
+        return _iter_file(self._native, file)
+
+    def match(self, matcher, query):
+        return _match(self._native, matcher, query)
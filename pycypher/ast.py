@@ -11,45 +11,76 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+from pycypher.bindings import AstNode as _AstNode
+from pycypher.bindings import structural_hash as _structural_hash
+from pycypher.bindings import traverse as _traverse
 from pycypher.getters import GettersMixin
 
 
-class CypherAstNode(GettersMixin):
-    def __init__(self, id, type, instanceof, children, props, start, end):
+# Maps a node type to the frozenset of types its nodes are instances of. The
+# bindings share a single instanceof tuple between all nodes of a type, so one
+# set per type is enough.
+_instanceof_sets = {}
+
+
+class CypherAstNode(_AstNode, GettersMixin):
+    """A node of the AST. Its fields live in the slots of the native AstNode
+    base, and the bindings build nodes of this class and its subclasses
+    without calling __init__, which is only used for nodes built otherwise.
+    """
+    __slots__ = ()
+
+    def __init__(
+        self, id, type, instanceof, children, props, start, end, index=None,
+        hash=None
+    ):
+        """Nodes referenced by props are looked up by id in index, which
+        the bindings share between all nodes of a parse result and in which
+        every node registers itself. Without an index the subtree of the node
+        is indexed instead. The bindings number nodes densely in pre-order
+        across all roots of a parse result and use that as their id.
+
+        hash is the structural hash of the subtree, which the bindings
+        compute while building it. Without it the hash is computed on first
+        use.
+        """
         self._id = id
         self._type = type
         self._instanceof = instanceof
-        self._children = children
+        self._children = tuple(children)
         self._props = props
-        self._indirect_props = []
         self._start = start
         self._end = end
         self._roles = []
-        self._init_props()
+        self._hash = hash
+        for child in self._children:
+            child._parent = self
+        if index is None:
+            index = dict((d.id, d) for d in self._all_descendants())
+        self._init_props(index)
+        index[id] = self
 
-    def _init_props(self):
+    def _init_props(self, index):
+        # Maps a role to the nodes in that role, in the order of props.
+        self._role_nodes = {}
         for k, v in list(self._props.items()):
             if isinstance(v, dict):
-                self._add_child_role(**v)
+                self._add_child_role(index, **v)
                 del self._props[k]
             elif isinstance(v, list) and v and isinstance(v[0], dict):
                 for i in v:
-                    self._add_child_role(**i)
+                    self._add_child_role(index, **i)
                 del self._props[k]
             elif isinstance(v, list) and not v:
                 del self._props[k]
 
-    def _add_child_role(self, id, role):
-        for child in self._children:
-            if child.id == id:
-                child._roles.append(role)
-                return
-        for d in self._all_descendants():
-            if d.id == id:
-                d._roles.append(role)
-                self._indirect_props.append(role)
-                return
-        raise ValueError('Child with id %d not found.' % id)
+    def _add_child_role(self, index, id, role):
+        try:
+            node = index[id]
+        except KeyError:
+            raise ValueError('Child with id %d not found.' % id)
+        node._roles.append(role)
+        self._role_nodes.setdefault(role, []).append(node)
 
     def _all_descendants(self):
         for child in self._children:
@@ -65,8 +96,47 @@ class CypherAstNode(GettersMixin):
     def type(self):
         return self._type
 
+    @property
+    def parent(self):
+        """The node this one is a child of, None for roots. Nodes keep
+        their ancestors alive, so this holds after the root is dropped.
+        """
+        return self._parent
+
+    @property
+    def depth(self):
+        """The number of ancestors of the node, 0 for roots."""
+        if self._depth is None:
+            return sum(1 for _ in self.ancestors())
+        return self._depth
+
+    def ancestors(self):
+        """Return an iterable of the ancestors of the node, from its parent
+        up to the root.
+        """
+        node = self._parent
+        while node is not None:
+            yield node
+            node = node._parent
+
+    def enclosing(self, type=None, instanceof=None):
+        """Return the closest ancestor of the node of the given type, or
+        instance of the given type, or None if there is none. Only the
+        ancestors are visited, so this doesn't depend on the size of the tree.
+        """
+        for node in self.ancestors():
+            if ((type is None or node.type == type) and
+                    (instanceof is None or node.instanceof(instanceof))):
+                return node
+        return None
+
     def instanceof(self, type):
-        return type in self._instanceof
+        types = _instanceof_sets.get(self._type)
+        if types is None:
+            types = _instanceof_sets.setdefault(
+                self._type, frozenset(self._instanceof)
+            )
+        return type in types
 
     @property
     def children(self):
@@ -91,26 +161,55 @@ class CypherAstNode(GettersMixin):
         matching the criteria given as keyword arguments. Return all nodes from
         the subtree if called without any arguments.
         """
-        def pred(node):
-            result = True
-            if type is not None:
-                result = result and node.type == type
-            if role is not None:
-                result = result and role in node._roles
-            if instanceof is not None:
-                result = result and node.instanceof(instanceof)
-            if start is not None:
-                result = result and node.start >= start
-            if end is not None:
-                result = result and node.end <= end
-            return result
-
-        if pred(self):
-            yield self
-
-        for d in self._all_descendants():
-            if pred(d):
-                yield d
+        return iter(self.traverse(
+            instanceof=instanceof, type=type, role=role, start=start, end=end
+        ))
+
+    def traverse(
+        self, instanceof=None, type=None, role=None, start=None, end=None,
+        order='pre', prune=None, callback=None
+    ):
+        """Walk the subtree of this node (including it) natively, in
+        pre-order or post-order, and return the list of nodes matching the
+        criteria of find_nodes.
+
+        Descendants of nodes for which prune(node) is true are skipped, as are
+        subtrees outside of the [start, end] range. With a callback, it's
+        called on every match instead, the walk stops as soon as it returns a
+        true value, and the number of matches is returned.
+        """
+        if order not in ('pre', 'post'):
+            raise ValueError("order must be 'pre' or 'post'")
+        return _traverse(
+            self, type, instanceof, role, start, end, order == 'post', prune,
+            callback
+        )
+
+    def __hash__(self):
+        if self._hash is None:
+            self._hash = _structural_hash(
+                self._type, self._props, [hash(c) for c in self._children],
+                _child_roles(self)
+            )
+        return self._hash
+
+    def __eq__(self, other):
+        """Nodes are equal when their subtrees are structurally identical:
+        same types, non-AST props, children and roles of the children,
+        whatever their ids and ranges. Different structural hashes tell
+        unequal subtrees apart in constant time; equal ones are confirmed by
+        comparing the subtrees, so that a hash collision can't make different
+        subtrees equal.
+        """
+        if not isinstance(other, CypherAstNode):
+            return NotImplemented
+        return self is other or (
+            hash(self) == hash(other) and _same_structure(self, other)
+        )
+
+    def __ne__(self, other):
+        result = self.__eq__(other)
+        return result if result is NotImplemented else not result
 
     def __repr__(self):
         return "<CypherAstNode.%s>" % self.type
@@ -122,10 +221,134 @@ class CypherAstNode(GettersMixin):
         children = [child.to_json() for child in self._children]
         return {
             "type": self._type,
-            "instanceof": self._instanceof,
+            "instanceof": list(self._instanceof),
             "children": children,
             "props": self._props,
             "start": self._start,
             "end": self._end,
             "roles": self._roles,
         }
+
+
+def _child_roles(node):
+    # The sorted roles the node gives each of its children. Roles it gives
+    # deeper descendants aren't part of the structure of the children, and
+    # _roles would also hold the roles given by the node's ancestors.
+    children = node._children
+    if not children:
+        return []
+    positions = dict((id(c), i) for i, c in enumerate(children))
+    roles = [[] for _ in children]
+    for role, nodes in node._role_nodes.items():
+        for n in nodes:
+            i = positions.get(id(n))
+            if i is not None:
+                roles[i].append(role)
+    for r in roles:
+        r.sort()
+    return roles
+
+
+def _same_structure(a, b):
+    # Walks both subtrees with a stack, as they may be deeper than the
+    # recursion limit.
+    pairs = [(a, b)]
+    while pairs:
+        a, b = pairs.pop()
+        if a is b:
+            continue
+        if (a._type != b._type or a._props != b._props or
+                len(a._children) != len(b._children) or
+                _child_roles(a) != _child_roles(b)):
+            return False
+        for x, y in zip(a._children, b._children):
+            if x is not y and hash(x) != hash(y):
+                return False
+            pairs.append((x, y))
+    return True
+
+
+class LazyCypherAstNode(CypherAstNode):
+    """A CypherAstNode backed by the native parse result, which stays alive for
+    as long as any node referencing it. Children, props and roles are only
+    built when first accessed, so the cost of a parse scales with the part of
+    the tree that is actually visited.
+    """
+    def __init__(self, ref, parent=None):
+        self._ref = ref
+        self._parent = parent
+        self._depth = 0 if parent is None else parent._depth + 1
+        self._roles = []
+        self._hash = None
+        self._lazy_children = None
+        self._lazy_props = None
+        self._lazy_role_nodes = None
+
+    def _materialize(self):
+        if self._lazy_children is not None:
+            return
+        self._lazy_children = [
+            LazyCypherAstNode(ref, self) for ref in self._ref.children()
+        ]
+        self._lazy_props = self._ref.props()
+        self._init_props(_DescendantIndex(self))
+
+    @property
+    def _id(self):
+        return self._ref.id
+
+    @property
+    def _type(self):
+        return self._ref.type
+
+    @property
+    def _instanceof(self):
+        return self._ref.instanceof
+
+    @property
+    def _start(self):
+        return self._ref.start
+
+    @property
+    def _end(self):
+        return self._ref.end
+
+    @property
+    def _children(self):
+        self._materialize()
+        return self._lazy_children
+
+    @property
+    def _props(self):
+        self._materialize()
+        return self._lazy_props
+
+    @property
+    def _role_nodes(self):
+        self._materialize()
+        return self._lazy_role_nodes
+
+    @_role_nodes.setter
+    def _role_nodes(self, value):
+        self._lazy_role_nodes = value
+
+    def __repr__(self):
+        return "<CypherAstNode.%s>" % self.type
+
+
+class _DescendantIndex(dict):
+    """Index of the children of a LazyCypherAstNode, which only materializes
+    deeper descendants when one of them is looked up.
+    """
+    def __init__(self, node):
+        super(_DescendantIndex, self).__init__(
+            (child.id, child) for child in node._lazy_children
+        )
+        self._node = node
+
+    def __missing__(self, id):
+        for d in self._node._all_descendants():
+            if d.id == id:
+                self[id] = d
+                return d
+        raise KeyError(id)
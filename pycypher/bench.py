@@ -0,0 +1,222 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Benchmarks of the binding layer.
+
+Every query of the corpus is parsed repeatedly and the time is split into
+phases:
+
+ - parse: the native parse alone, as done by validate
+ - convert: building arguments and props of every node and calling the node
+   class, measured with a class whose __init__ does nothing, minus parse
+ - init: CypherAstNode.__init__, the rest of a parse_query
+
+along with the peak of Python allocations during a parse_query and the growth
+of the peak RSS of the process. Run
+
+    python -m pycypher.bench [--output results.json] [--compare old.json]
+
+to print a table and store the results as JSON, optionally comparing them to
+results stored earlier, for example by a build of another commit.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import platform
+import sys
+import time
+
+try:
+    import resource
+except ImportError:
+    resource = None
+try:
+    import tracemalloc
+except ImportError:
+    tracemalloc = None
+
+from pycypher import bindings, CypherAstNode, CypherParseError, __version__
+
+
+MEDIUM_QUERY = (
+    "MATCH (a:Person {name: $name})-[:KNOWS*1..3]->(b:Person) "
+    "WHERE b.age > 30 AND NOT (b)-[:BLOCKED]->(a) "
+    "WITH b, count(*) AS paths ORDER BY paths DESC LIMIT 10 "
+    "RETURN b.name AS name, paths, [x IN range(1, 5) | x * paths] AS l;"
+)
+
+
+def corpus(scale=1):
+    """Return a list of (name, query) tuples, from small to pathological.
+    scale multiplies the size of the pathological queries.
+    """
+    return [
+        ('small', "MATCH (n) RETURN n;"),
+        ('medium', MEDIUM_QUERY),
+        ('deep_nesting', "RETURN %s1%s;" % (
+            '(' * 200 * scale, ')' * 200 * scale
+        )),
+        ('huge_list', "RETURN [%s];" % ', '.join(
+            str(i) for i in range(20000 * scale)
+        )),
+        ('union_chain', ' UNION '.join(
+            "MATCH (n:L%d) RETURN n" % i for i in range(500 * scale)
+        ) + ';'),
+        ('large_script', '\n'.join([MEDIUM_QUERY] * 2000 * scale)),
+    ]
+
+
+class _BareNode(object):
+    __slots__ = ()
+
+    def __init__(self, *args):
+        pass
+
+
+def _best_time(repeat, function, *args):
+    best = None
+    for _ in range(repeat):
+        start = time.time()
+        function(*args)
+        elapsed = time.time() - start
+        if best is None or elapsed < best:
+            best = elapsed
+    return best
+
+
+def _peak_rss():
+    if resource is None:
+        return None
+    # Kilobytes on Linux, bytes on macOS.
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return rss if sys.platform == 'darwin' else rss * 1024
+
+
+def _peak_allocated(query):
+    if tracemalloc is None:
+        return None
+    tracemalloc.start()
+    try:
+        bindings.parse_query(CypherAstNode, CypherParseError, query)
+        return tracemalloc.get_traced_memory()[1]
+    finally:
+        tracemalloc.stop()
+
+
+def measure(query, repeat=5):
+    """Return a dict of timings in seconds, the best of repeat runs, and of
+    memory use in bytes for a single query.
+    """
+    rss_before = _peak_rss()
+    parse = _best_time(
+        repeat, bindings.validate, CypherParseError, query
+    )
+    convert = _best_time(
+        repeat, bindings.parse_query, _BareNode, CypherParseError, query
+    )
+    total = _best_time(
+        repeat, bindings.parse_query, CypherAstNode, CypherParseError, query
+    )
+    rss_after = _peak_rss()
+    errors, nnodes, _ = bindings.validate(CypherParseError, query)
+    return {
+        'bytes': len(query),
+        'nodes': nnodes,
+        'errors': len(errors),
+        'parse': parse,
+        'convert': max(convert - parse, 0.0),
+        'init': max(total - convert, 0.0),
+        'total': total,
+        'peak_allocated': _peak_allocated(query),
+        'peak_rss_growth': (
+            None if rss_before is None else rss_after - rss_before
+        ),
+    }
+
+
+def run(queries=None, repeat=5):
+    """Measure every (name, query) of queries, the corpus by default, and
+    return the results along with a description of the environment.
+    """
+    if queries is None:
+        queries = corpus()
+    return {
+        'version': __version__,
+        'python': platform.python_version(),
+        'platform': platform.platform(),
+        'time': time.time(),
+        'repeat': repeat,
+        'results': dict(
+            (name, measure(query, repeat)) for name, query in queries
+        ),
+    }
+
+
+def compare(old, new):
+    """Return a dict from query name to the ratio of the new total time to
+    the old one, for the queries measured in both runs.
+    """
+    result = {}
+    for name, stats in new['results'].items():
+        old_stats = old['results'].get(name)
+        if old_stats and old_stats['total']:
+            result[name] = stats['total'] / old_stats['total']
+    return result
+
+
+def _format_ms(seconds):
+    return '%9.3f' % (seconds * 1000)
+
+
+def _print_table(results, ratios):
+    print('%-14s %9s %9s %9s %9s %12s %8s' % (
+        'query', 'parse ms', 'conv ms', 'init ms', 'total ms', 'peak alloc',
+        'vs old'
+    ))
+    for name in sorted(results['results']):
+        stats = results['results'][name]
+        ratio = ratios.get(name)
+        print('%-14s %s %s %s %s %12s %8s' % (
+            name,
+            _format_ms(stats['parse']),
+            _format_ms(stats['convert']),
+            _format_ms(stats['init']),
+            _format_ms(stats['total']),
+            stats['peak_allocated'] if stats['peak_allocated'] is not None
+            else '-',
+            '%.2fx' % ratio if ratio is not None else '-',
+        ))
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(prog='python -m pycypher.bench')
+    parser.add_argument('--repeat', type=int, default=5)
+    parser.add_argument('--scale', type=int, default=1)
+    parser.add_argument('--output', help='store the results as JSON')
+    parser.add_argument('--compare', help='JSON results of an earlier run')
+    args = parser.parse_args(argv)
+
+    results = run(corpus(args.scale), args.repeat)
+    ratios = {}
+    if args.compare:
+        with open(args.compare) as f:
+            ratios = compare(json.load(f), results)
+    _print_table(results, ratios)
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+
+
+if __name__ == '__main__':
+    main()
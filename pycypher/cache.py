@@ -0,0 +1,76 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import collections
+import threading
+
+
+CacheInfo = collections.namedtuple(
+    'CacheInfo', ['hits', 'misses', 'maxsize', 'currsize', 'shapes']
+)
+
+
+class ParseCache(object):
+    """A thread-safe LRU mapping from query text to parsed ASTs, together with
+    the fingerprint of each query.
+
+    Cached ASTs are shared between all callers parsing the same text, so they
+    must be treated as read-only.
+    """
+
+    def __init__(self, maxsize):
+        self._maxsize = maxsize
+        self._entries = collections.OrderedDict()
+        self._lock = threading.Lock()
+        self._hits = 0
+        self._misses = 0
+
+    def get(self, query, field):
+        """Return the cached ASTs (field 0) or fingerprint (field 1) of the
+        query, or None if they aren't cached.
+        """
+        with self._lock:
+            entry = self._entries.pop(query, None)
+            if entry is not None:
+                self._entries[query] = entry
+                if entry[field] is not None:
+                    self._hits += 1
+                    return entry[field]
+            self._misses += 1
+            return None
+
+    def put(self, query, asts, fingerprint):
+        """Cache the ASTs and fingerprint of the query, either of which may
+        be None if it hasn't been computed.
+        """
+        with self._lock:
+            old = self._entries.pop(query, None)
+            if old is not None:
+                asts = asts if asts is not None else old[0]
+                fingerprint = (
+                    fingerprint if fingerprint is not None else old[1]
+                )
+            self._entries[query] = (asts, fingerprint)
+            while len(self._entries) > self._maxsize:
+                self._entries.popitem(last=False)
+
+    def info(self):
+        with self._lock:
+            shapes = set(
+                fingerprint for _, fingerprint in self._entries.values()
+                if fingerprint is not None
+            )
+            return CacheInfo(
+                self._hits, self._misses, self._maxsize, len(self._entries),
+                len(shapes),
+            )
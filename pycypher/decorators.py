@@ -11,7 +11,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
-import functools
+from .bindings import Getter
 
 
 def get_prop_name_from_method(method):
@@ -30,38 +30,18 @@ def get_prop_name_from_method(method):
 
 
 def pycypher_getter(method):
+    """Return a native getter returning the prop named after the method, or
+    else the only child in the role of that name, or None.
+    """
     name = get_prop_name_from_method(method)
-    @functools.wraps(method)
-    def wrapper(self):
-        if name in self._props:
-            return self._props[name]
-        if name in self._indirect_props:
-            children = self._all_descendants()
-        else:
-            children = self._children
-        children = [child for child in children if name in child._roles]
-        if not children:
-            return None
-        elif len(children) == 1:
-            return children[0]
-        else:
-            raise ValueError(
-                'Multiple children with singleton role "%s".' % name
-            )
-    return wrapper
+    return Getter(name, name, method.__name__, method.__doc__)
 
 
 def pycypher_list_getter(role):
+    """Return a decorator making a native getter returning the prop named
+    after the method, or else the list of children in role.
+    """
     def inner(method):
         name = get_prop_name_from_method(method)
-        @functools.wraps(method)
-        def wrapper(self):
-            if name in self._props:
-                return self._props[name]
-            if role in self._indirect_props:
-                children = self._all_descendants()
-            else:
-                children = self._children
-            return [child for child in children if role in child._roles]
-        return wrapper
+        return Getter(name, role, method.__name__, method.__doc__, True)
     return inner
@@ -0,0 +1,60 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+class FlatAst(object):
+    """A whole parse result as flat arrays with one element per node, nodes
+    being numbered in pre-order. The arrays are memoryviews over bytes built by
+    the bindings, so they can be handed to e.g. numpy.frombuffer without
+    copying:
+
+     - types: node type ids, see type_names
+     - parents: index of the parent node or -1 for roots
+     - child_offsets, children: children of node i are
+       children[child_offsets[i]:child_offsets[i + 1]]
+     - starts, ends: offsets of the node in the query
+     - string_offsets, strings: value of the first string prop of node i
+       (e.g. name of an identifier) is
+       strings[string_offsets[i]:string_offsets[i + 1]], UTF-8 encoded
+     - roots: indices of the root nodes
+    """
+    _formats = {
+        'types': 'B',
+        'parents': 'i',
+        'child_offsets': 'I',
+        'children': 'I',
+        'starts': 'Q',
+        'ends': 'Q',
+        'string_offsets': 'I',
+        'strings': 'B',
+        'roots': 'I',
+    }
+
+    def __init__(self, columns):
+        for name, format in self._formats.items():
+            setattr(self, name, memoryview(columns[name]).cast(format))
+        self.type_names = columns['type_names']
+
+    def __len__(self):
+        return len(self.types)
+
+    def type(self, i):
+        return self.type_names[self.types[i]]
+
+    def string(self, i):
+        return self.strings[
+            self.string_offsets[i]:self.string_offsets[i + 1]
+        ].tobytes().decode('utf-8')
+
+    def children_of(self, i):
+        return self.children[self.child_offsets[i]:self.child_offsets[i + 1]]
@@ -1,8 +1,10 @@
 # THIS FILE IS AUTOGENERATED, DO NOT EDIT
+# Duplicate getters are removed by dedupe_getters.py
 from .decorators import pycypher_getter, pycypher_list_getter
 
 
 class GettersMixin(object):
+    __slots__ = ()
 
     @pycypher_getter
     def get_direction(self):
@@ -12,10 +14,6 @@ class GettersMixin(object):
     def get_operator(self):
         pass
 
-    @pycypher_getter
-    def get_operator(self):
-        pass
-
     @pycypher_list_getter('operator')
     def get_operators(self):
         pass
@@ -24,22 +22,6 @@ class GettersMixin(object):
     def get_distinct(self):
         pass
 
-    @pycypher_getter
-    def get_distinct(self):
-        pass
-
-    @pycypher_getter
-    def is_unique(self):
-        pass
-
-    @pycypher_getter
-    def is_unique(self):
-        pass
-
-    @pycypher_getter
-    def is_unique(self):
-        pass
-
     @pycypher_getter
     def is_unique(self):
         pass
@@ -48,14 +30,6 @@ class GettersMixin(object):
     def is_optional(self):
         pass
 
-    @pycypher_getter
-    def is_unique(self):
-        pass
-
-    @pycypher_getter
-    def is_distinct(self):
-        pass
-
     @pycypher_getter
     def is_distinct(self):
         pass
@@ -80,10 +54,6 @@ class GettersMixin(object):
     def has_include_existing(self):
         pass
 
-    @pycypher_getter
-    def has_include_existing(self):
-        pass
-
     @pycypher_getter
     def has_all(self):
         pass
@@ -92,10 +62,6 @@ class GettersMixin(object):
     def get_name(self):
         pass
 
-    @pycypher_getter
-    def get_name(self):
-        pass
-
     @pycypher_getter
     def get_value(self):
         pass
@@ -104,46 +70,6 @@ class GettersMixin(object):
     def get_valuestr(self):
         pass
 
-    @pycypher_getter
-    def get_valuestr(self):
-        pass
-
-    @pycypher_getter
-    def get_name(self):
-        pass
-
-    @pycypher_getter
-    def get_name(self):
-        pass
-
-    @pycypher_getter
-    def get_value(self):
-        pass
-
-    @pycypher_getter
-    def get_value(self):
-        pass
-
-    @pycypher_getter
-    def get_value(self):
-        pass
-
-    @pycypher_getter
-    def get_value(self):
-        pass
-
-    @pycypher_getter
-    def get_value(self):
-        pass
-
-    @pycypher_getter
-    def get_value(self):
-        pass
-
-    @pycypher_getter
-    def get_value(self):
-        pass
-
     @pycypher_list_getter('option')
     def get_options(self):
         pass
@@ -152,10 +78,6 @@ class GettersMixin(object):
     def get_params(self):
         pass
 
-    @pycypher_list_getter('option')
-    def get_options(self):
-        pass
-
     @pycypher_list_getter('clause')
     def get_clauses(self):
         pass
@@ -168,10 +90,6 @@ class GettersMixin(object):
     def get_ids(self):
         pass
 
-    @pycypher_list_getter('id')
-    def get_ids(self):
-        pass
-
     @pycypher_list_getter('hint')
     def get_hints(self):
         pass
@@ -188,14 +106,6 @@ class GettersMixin(object):
     def get_items(self):
         pass
 
-    @pycypher_list_getter('item')
-    def get_items(self):
-        pass
-
-    @pycypher_list_getter('item')
-    def get_items(self):
-        pass
-
     @pycypher_list_getter('label')
     def get_labels(self):
         pass
@@ -204,38 +114,10 @@ class GettersMixin(object):
     def get_expressions(self):
         pass
 
-    @pycypher_list_getter('item')
-    def get_items(self):
-        pass
-
-    @pycypher_list_getter('label')
-    def get_labels(self):
-        pass
-
-    @pycypher_list_getter('clause')
-    def get_clauses(self):
-        pass
-
-    @pycypher_list_getter('projection')
-    def get_projections(self):
-        pass
-
-    @pycypher_list_getter('argument')
-    def get_arguments(self):
-        pass
-
     @pycypher_list_getter('projection')
     def get_projections(self):
         pass
 
-    @pycypher_list_getter('projection')
-    def get_projections(self):
-        pass
-
-    @pycypher_list_getter('item')
-    def get_items(self):
-        pass
-
     @pycypher_list_getter('argument')
     def get_arguments(self):
         pass
@@ -244,10 +126,6 @@ class GettersMixin(object):
     def get_selectors(self):
         pass
 
-    @pycypher_list_getter('label')
-    def get_labels(self):
-        pass
-
     @pycypher_list_getter('predicate')
     def get_predicates(self):
         pass
@@ -260,10 +138,6 @@ class GettersMixin(object):
     def get_keys(self):
         pass
 
-    @pycypher_list_getter('value')
-    def get_values(self):
-        pass
-
     @pycypher_list_getter('path')
     def get_paths(self):
         pass
@@ -272,22 +146,10 @@ class GettersMixin(object):
     def get_elements(self):
         pass
 
-    @pycypher_list_getter('label')
-    def get_labels(self):
-        pass
-
     @pycypher_list_getter('reltype')
     def get_reltypes(self):
         pass
 
-    @pycypher_list_getter('argument')
-    def get_arguments(self):
-        pass
-
-    @pycypher_list_getter('argument')
-    def get_arguments(self):
-        pass
-
     @pycypher_getter
     def get_body(self):
         pass
@@ -296,22 +158,6 @@ class GettersMixin(object):
     def get_version(self):
         pass
 
-    @pycypher_getter
-    def get_name(self):
-        pass
-
-    @pycypher_getter
-    def get_value(self):
-        pass
-
-    @pycypher_getter
-    def get_label(self):
-        pass
-
-    @pycypher_getter
-    def get_prop_name(self):
-        pass
-
     @pycypher_getter
     def get_label(self):
         pass
@@ -324,50 +170,14 @@ class GettersMixin(object):
     def get_identifier(self):
         pass
 
-    @pycypher_getter
-    def get_label(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_label(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_reltype(self):
-        pass
-
     @pycypher_getter
     def get_expression(self):
         pass
 
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
     @pycypher_getter
     def get_reltype(self):
         pass
 
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
     @pycypher_getter
     def get_limit(self):
         pass
@@ -376,10 +186,6 @@ class GettersMixin(object):
     def get_url(self):
         pass
 
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
     @pycypher_getter
     def get_field_terminator(self):
         pass
@@ -388,158 +194,30 @@ class GettersMixin(object):
     def get_predicate(self):
         pass
 
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
     @pycypher_getter
     def get_index_name(self):
         pass
 
-    @pycypher_getter
-    def get_prop_name(self):
-        pass
-
     @pycypher_getter
     def get_lookup(self):
         pass
 
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_index_name(self):
-        pass
-
     @pycypher_getter
     def get_query(self):
         pass
 
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_index_name(self):
-        pass
-
-    @pycypher_getter
-    def get_prop_name(self):
-        pass
-
-    @pycypher_getter
-    def get_lookup(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_index_name(self):
-        pass
-
-    @pycypher_getter
-    def get_query(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
     @pycypher_getter
     def get_pattern(self):
         pass
 
-    @pycypher_getter
-    def get_predicate(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_label(self):
-        pass
-
-    @pycypher_getter
-    def get_prop_name(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_label(self):
-        pass
-
     @pycypher_getter
     def get_pattern_path(self):
         pass
 
-    @pycypher_getter
-    def get_pattern(self):
-        pass
-
-    @pycypher_getter
-    def get_property(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
     @pycypher_getter
     def get_property(self):
         pass
 
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
     @pycypher_getter
     def get_order_by(self):
         pass
@@ -548,18 +226,6 @@ class GettersMixin(object):
     def get_skip(self):
         pass
 
-    @pycypher_getter
-    def get_limit(self):
-        pass
-
-    @pycypher_getter
-    def get_predicate(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
     @pycypher_getter
     def get_alias(self):
         pass
@@ -568,30 +234,6 @@ class GettersMixin(object):
     def get_proc_name(self):
         pass
 
-    @pycypher_getter
-    def get_order_by(self):
-        pass
-
-    @pycypher_getter
-    def get_skip(self):
-        pass
-
-    @pycypher_getter
-    def get_limit(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_alias(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
     @pycypher_getter
     def get_argument(self):
         pass
@@ -608,30 +250,10 @@ class GettersMixin(object):
     def get_func_name(self):
         pass
 
-    @pycypher_getter
-    def get_func_name(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_prop_name(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
     @pycypher_getter
     def get_subscript(self):
         pass
 
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
     @pycypher_getter
     def get_start(self):
         pass
@@ -640,58 +262,6 @@ class GettersMixin(object):
     def get_end(self):
         pass
 
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_prop_name(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_prop_name(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_predicate(self):
-        pass
-
-    @pycypher_getter
-    def get_eval(self):
-        pass
-
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_pattern(self):
-        pass
-
-    @pycypher_getter
-    def get_predicate(self):
-        pass
-
     @pycypher_getter
     def get_eval(self):
         pass
@@ -704,66 +274,18 @@ class GettersMixin(object):
     def get_init(self):
         pass
 
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
-    @pycypher_getter
-    def get_eval(self):
-        pass
-
-    @pycypher_getter
-    def get_expression(self):
-        pass
-
     @pycypher_getter
     def get_default(self):
         pass
 
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
-    @pycypher_getter
-    def get_path(self):
-        pass
-
     @pycypher_getter
     def get_path(self):
         pass
 
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
     @pycypher_getter
     def get_properties(self):
         pass
 
-    @pycypher_getter
-    def get_identifier(self):
-        pass
-
     @pycypher_getter
     def get_varlength(self):
         pass
-
-    @pycypher_getter
-    def get_properties(self):
-        pass
-
-    @pycypher_getter
-    def get_start(self):
-        pass
-
-    @pycypher_getter
-    def get_end(self):
-        pass
-
-    @pycypher_getter
-    def get_name(self):
-        pass
\ No newline at end of file
@@ -0,0 +1,225 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Parallel parsing of query logs holding one query per line.
+
+The log is mapped into memory and split into shards ending on line
+boundaries, which worker processes map and parse on their own, so only the
+per-query outcomes, already formatted when writing them out, travel
+between processes. Results come back in file order. Run
+
+    python -m pycypher.ingest LOG [--workers N] [--format jsonl|table]
+
+to write one record per non-blank line of LOG to stdout or --output:
+
+ - jsonl: a JSON object per line with the offset and length of the query in
+   the log, ok, nerrors, error_offset (relative to the query, null if ok),
+   fingerprint (see pycypher.fingerprint) and nnodes
+ - table: TABLE_MAGIC followed by little-endian TABLE_RECORD structs of
+   offset, length, nerrors, error_offset (-1 if ok), fingerprint and nnodes
+"""
+
+import argparse
+import collections
+import json
+import mmap
+import multiprocessing
+import os
+import struct
+import sys
+
+from pycypher import bindings
+
+
+DEFAULT_SHARD_SIZE = 4 << 20
+
+TABLE_MAGIC = b'PYCYPHER-SCAN-1\n'
+TABLE_RECORD = struct.Struct('<QIIqQI')
+
+
+QueryOutcome = collections.namedtuple('QueryOutcome', [
+    'offset', 'length', 'nerrors', 'error_offset', 'fingerprint', 'nnodes'
+])
+
+
+class Scan(object):
+    """Outcomes of the queries of a shard as flat arrays with one element
+    per query, memoryviews over bytes built by the bindings:
+
+     - offsets, lengths: where the query is in the log, in bytes
+     - nerrors: number of parse errors, 0 for valid queries
+     - error_offsets: offset of the first error in the query, or -1
+     - fingerprints: see pycypher.fingerprint, meaningful for valid queries
+     - nnodes: number of AST nodes
+    """
+    _formats = {
+        'offsets': 'Q',
+        'lengths': 'I',
+        'nerrors': 'I',
+        'error_offsets': 'q',
+        'fingerprints': 'Q',
+        'nnodes': 'I',
+    }
+
+    def __init__(self, columns):
+        for name, format in self._formats.items():
+            setattr(self, name, memoryview(columns[name]).cast(format))
+
+    def __len__(self):
+        return len(self.offsets)
+
+    def __iter__(self):
+        for i in range(len(self)):
+            yield QueryOutcome(
+                self.offsets[i], self.lengths[i], self.nerrors[i],
+                self.error_offsets[i], self.fingerprints[i], self.nnodes[i]
+            )
+
+    def to_jsonl(self):
+        """Return the outcomes as UTF-8 encoded JSON lines, see the module."""
+        lines = []
+        for outcome in self:
+            ok = outcome.nerrors == 0
+            lines.append(json.dumps({
+                'offset': outcome.offset,
+                'length': outcome.length,
+                'ok': ok,
+                'nerrors': outcome.nerrors,
+                'error_offset': None if ok else outcome.error_offset,
+                'fingerprint': outcome.fingerprint,
+                'nnodes': outcome.nnodes,
+            }, sort_keys=True) + '\n')
+        return ''.join(lines).encode('utf-8')
+
+    def to_table(self):
+        """Return the outcomes as TABLE_RECORD structs, see the module."""
+        return b''.join(TABLE_RECORD.pack(*outcome) for outcome in self)
+
+
+def shards(data, shard_size=DEFAULT_SHARD_SIZE):
+    """Return a list of (start, end) ranges covering data, each of roughly
+    shard_size bytes and ending just after a newline or at the end of data.
+    """
+    result = []
+    start = 0
+    while start < len(data):
+        end = data.find(
+            b'\n', min(start + max(shard_size, 1), len(data)) - 1
+        )
+        end = len(data) if end < 0 else end + 1
+        result.append((start, end))
+        start = end
+    return result
+
+
+def _map(fd):
+    if os.fstat(fd).st_size == 0:
+        return None
+    return mmap.mmap(fd, 0, access=mmap.ACCESS_READ)
+
+
+def _scan_shard(task):
+    path, start, end = task[:3]
+    with open(path, 'rb') as f:
+        data = _map(f.fileno())
+    try:
+        return bindings.scan_lines(data, start, end)
+    finally:
+        data.close()
+
+
+def _dump_shard(task):
+    scan = Scan(_scan_shard(task))
+    return scan.to_table() if task[3] == 'table' else scan.to_jsonl()
+
+
+def _run(function, path, workers, shard_size, *args):
+    # Yield function((path, start, end) + args) for every shard of the file,
+    # in file order.
+    with open(path, 'rb') as f:
+        data = _map(f.fileno())
+    if data is None:
+        return
+    try:
+        ranges = shards(data, shard_size)
+    finally:
+        data.close()
+    tasks = [(path, start, end) + args for start, end in ranges]
+    workers = min(workers or multiprocessing.cpu_count(), len(tasks))
+    if workers <= 1:
+        for task in tasks:
+            yield function(task)
+        return
+    pool = multiprocessing.Pool(workers)
+    try:
+        for result in pool.imap(function, tasks):
+            yield result
+    finally:
+        pool.terminate()
+        pool.join()
+
+
+def scan_file(path, workers=None, shard_size=DEFAULT_SHARD_SIZE):
+    """Parse every non-blank line of the file at path as a query on up to
+    `workers` processes (one per CPU by default) and yield a Scan per shard,
+    in file order.
+    """
+    for columns in _run(_scan_shard, path, workers, shard_size):
+        yield Scan(columns)
+
+
+def scan_log(path, workers=None, shard_size=DEFAULT_SHARD_SIZE):
+    """Like scan_file, but yield a QueryOutcome per query."""
+    for scan in scan_file(path, workers, shard_size):
+        for outcome in scan:
+            yield outcome
+
+
+def dump_file(path, out, format='jsonl', workers=None,
+              shard_size=DEFAULT_SHARD_SIZE):
+    """Like scan_file, but write the outcomes to out, a binary file, in the
+    given format, 'jsonl' or 'table'. Workers format their own shards, so
+    the writer only copies bytes.
+    """
+    if format == 'table':
+        out.write(TABLE_MAGIC)
+    for chunk in _run(_dump_shard, path, workers, shard_size, format):
+        out.write(chunk)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(prog='python -m pycypher.ingest')
+    parser.add_argument('log', help='file holding one query per line')
+    parser.add_argument('--workers', type=int, default=None)
+    parser.add_argument(
+        '--shard-size', type=int, default=DEFAULT_SHARD_SIZE,
+        help='approximate size of the parts of the log handed to workers'
+    )
+    parser.add_argument(
+        '--format', choices=['jsonl', 'table'], default='jsonl'
+    )
+    parser.add_argument('--output', help='write to this file, not stdout')
+    args = parser.parse_args(argv)
+
+    if args.output:
+        with open(args.output, 'wb') as out:
+            dump_file(
+                args.log, out, args.format, args.workers, args.shard_size
+            )
+    else:
+        out = getattr(sys.stdout, 'buffer', sys.stdout)
+        dump_file(args.log, out, args.format, args.workers, args.shard_size)
+        out.flush()
+
+
+if __name__ == '__main__':
+    main()
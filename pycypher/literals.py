@@ -0,0 +1,80 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+class Literals(object):
+    """All literals and parameters of a query, in pre-order, as flat arrays
+    built by the bindings (see FlatAst):
+
+     - kinds: indices into kind_names
+     - starts, ends: offsets of the literal in the query
+     - value_offsets, values: the value of literal i, UTF-8 encoded, is
+       values[value_offsets[i]:value_offsets[i + 1]]; strings are unescaped,
+       numbers are given as written, parameters by name and true, false and
+       null as empty strings
+
+    template is the query with every literal (but not parameters) replaced by
+    a parameter named after the prefix and its number, counting literals only.
+    """
+    kind_names = (
+        'string', 'integer', 'float', 'true', 'false', 'null', 'parameter',
+    )
+    _formats = {
+        'kinds': 'B',
+        'starts': 'Q',
+        'ends': 'Q',
+        'value_offsets': 'I',
+        'values': 'B',
+    }
+
+    def __init__(self, columns, prefix):
+        for name, format in self._formats.items():
+            setattr(self, name, memoryview(columns[name]).cast(format))
+        self.template = columns['template']
+        self.prefix = prefix
+
+    def __len__(self):
+        return len(self.kinds)
+
+    def kind(self, i):
+        return self.kind_names[self.kinds[i]]
+
+    def value(self, i):
+        """Return the value of literal i converted to the matching Python
+        type, or the name of the parameter.
+        """
+        kind = self.kind(i)
+        text = self.values[
+            self.value_offsets[i]:self.value_offsets[i + 1]
+        ].tobytes().decode('utf-8')
+        if kind == 'integer':
+            return int(text, 0) if text[1:2] in ('x', 'X') else int(text)
+        if kind == 'float':
+            return float(text)
+        if kind == 'true':
+            return True
+        if kind == 'false':
+            return False
+        if kind == 'null':
+            return None
+        return text
+
+    def parameters(self):
+        """Return a dict of the values to pass along with the template."""
+        result = {}
+        n = 0
+        for i in range(len(self)):
+            if self.kinds[i] != self.kind_names.index('parameter'):
+                result['%s%d' % (self.prefix, n)] = self.value(i)
+                n += 1
+        return result
@@ -0,0 +1,105 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import weakref
+import pycypher
+from pycypher import bindings
+
+
+class TestNativeAstNode(unittest.TestCase):
+    def setUp(self):
+        self.ast, = pycypher.parse_query("MATCH (n) RETURN n + 1 AS x;")
+
+    def test_fields(self):
+        self.assertIsInstance(self.ast, bindings.AstNode)
+        self.assertFalse(hasattr(self.ast, '__dict__'))
+        self.assertIsInstance(self.ast.children, tuple)
+        self.assertEqual(self.ast.start, 0)
+        projection, = self.ast.find_nodes(type='CYPHER_AST_PROJECTION')
+        self.assertEqual(
+            sorted(child._roles[0] for child in projection.children),
+            ['alias', 'expression'],
+        )
+        weakref.ref(self.ast)
+
+    def test_getters(self):
+        self.assertIsInstance(pycypher.CypherAstNode.get_body, bindings.Getter)
+        self.assertEqual(pycypher.CypherAstNode.get_body.__name__, 'get_body')
+        clauses = self.ast.get_body().get_clauses()
+        self.assertEqual(
+            [c.type for c in clauses],
+            ['CYPHER_AST_MATCH', 'CYPHER_AST_RETURN'],
+        )
+        projection = clauses[1].get_projections()[0]
+        self.assertEqual(projection.get_alias().get_name(), 'x')
+        self.assertEqual(
+            projection.get_expression().get_operator(), 'CYPHER_OP_PLUS'
+        )
+        self.assertIsNone(clauses[1].get_skip())
+
+    def test_python_construction(self):
+        leaf = pycypher.CypherAstNode(
+            1, 'CYPHER_AST_IDENTIFIER', ('CYPHER_AST_IDENTIFIER',), [],
+            {'name': 'n'}, 0, 1
+        )
+        node = pycypher.CypherAstNode(
+            2, 'CYPHER_AST_PROJECTION', ('CYPHER_AST_PROJECTION',), [leaf],
+            {'alias': {'id': 1, 'role': 'alias'}}, 0, 1
+        )
+        self.assertEqual(node.get_alias(), leaf)
+        self.assertEqual(leaf._roles, ['alias'])
+        self.assertEqual(node.props, {})
+
+    def test_lazy(self):
+        lazy, = pycypher.parse_query("MATCH (n) RETURN n + 1 AS x;", lazy=True)
+        self.assertEqual(
+            len(lazy.get_body().get_clauses()),
+            len(self.ast.get_body().get_clauses()),
+        )
+
+    def test_direct_construction(self):
+        # Nodes built natively without props dicts match nodes built through
+        # CypherAstNode.__init__ from the full props.
+        def build(*args):
+            return pycypher.CypherAstNode(*args)
+        query = "MATCH (n) RETURN n + 1 AS x, [1, 2, 3] AS l, 'foo' AS s;"
+        native, = pycypher.parse_query(query)
+        built, = bindings.parse_query(
+            build, pycypher.CypherParseError, query
+        )[0]
+
+        def describe(node):
+            return (
+                node.type, node.props, list(node._roles), hash(node),
+                sorted(
+                    (role, [n.id for n in nodes])
+                    for role, nodes in node._role_nodes.items()
+                ),
+                [describe(child) for child in node.children],
+            )
+        self.assertEqual(describe(native), describe(built))
+
+    def test_named_path(self):
+        # The elements prop of a named path refers to the children of its
+        # pattern path, not to its own children.
+        for lazy in (False, True):
+            ast, = pycypher.parse_query("MATCH p = (n) RETURN p;", lazy=lazy)
+            match = ast.get_body().get_clauses()[0]
+            path, = match.get_pattern().get_paths()
+            self.assertEqual(path.type, 'CYPHER_AST_NAMED_PATH')
+            self.assertEqual(path.get_identifier().get_name(), 'p')
+            node, = path.get_elements()
+            self.assertEqual(node.type, 'CYPHER_AST_NODE_PATTERN')
+            self.assertIs(path.get_path().get_elements()[0], node)
+            self.assertEqual(sorted(node._roles), ['element', 'element'])
@@ -0,0 +1,35 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import json
+import unittest
+from pycypher import bench
+
+
+class TestBench(unittest.TestCase):
+    def test_corpus_parses(self):
+        for name, query in bench.corpus():
+            errors, nnodes, _ = bench.bindings.validate(
+                bench.CypherParseError, query
+            )
+            self.assertEqual(errors, [], name)
+            self.assertGreater(nnodes, 0, name)
+
+    def test_run(self):
+        results = bench.run([('small', "MATCH (n) RETURN n;")], repeat=1)
+        stats = results['results']['small']
+        for phase in ('parse', 'convert', 'init', 'total'):
+            self.assertGreaterEqual(stats[phase], 0)
+        self.assertGreater(stats['nodes'], 0)
+        results = json.loads(json.dumps(results))
+        self.assertEqual(bench.compare(results, results), {'small': 1.0})
@@ -0,0 +1,93 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+class TestFingerprint(unittest.TestCase):
+    def test_ignores_literals(self):
+        self.assertEqual(
+            pycypher.fingerprint("MATCH (n) RETURN n + 1, 'a', [true];"),
+            pycypher.fingerprint("MATCH (n) RETURN n + 2.5, $p, [null];"),
+        )
+
+    def test_structure(self):
+        base = pycypher.fingerprint("MATCH (n) RETURN n + 1;")
+        self.assertNotEqual(base, pycypher.fingerprint("MATCH (m) RETURN m + 1;"))
+        self.assertNotEqual(base, pycypher.fingerprint("MATCH (n) RETURN n;"))
+        self.assertNotEqual(base, pycypher.fingerprint("MATCH (n) RETURN [n];"))
+        self.assertNotEqual(
+            pycypher.fingerprint("RETURN [1, 2];"),
+            pycypher.fingerprint("RETURN [1];"),
+        )
+
+    def test_prop_of_children(self):
+        self.assertNotEqual(
+            pycypher.fingerprint("RETURN n SKIP 5;"),
+            pycypher.fingerprint("RETURN n LIMIT 5;"),
+        )
+        self.assertEqual(
+            pycypher.fingerprint("RETURN n SKIP 5;"),
+            pycypher.fingerprint("RETURN n SKIP $p;"),
+        )
+
+    def test_errors(self):
+        with self.assertRaises(pycypher.CypherParseError):
+            pycypher.fingerprint("RETURN 1 +;")
+
+
+class TestCache(unittest.TestCase):
+    def setUp(self):
+        pycypher.set_cache_size(2)
+
+    def tearDown(self):
+        pycypher.set_cache_size(None)
+
+    def test_shares_asts(self):
+        a = pycypher.parse_query("RETURN 1;")
+        b = pycypher.parse_query("RETURN 1;")
+        self.assertIsNot(a, b)
+        self.assertIs(a[0], b[0])
+        info = pycypher.cache_info()
+        self.assertEqual((info.hits, info.misses, info.currsize), (1, 1, 1))
+
+    def test_lru(self):
+        first = pycypher.parse_query("RETURN 1;")
+        pycypher.parse_query("RETURN 2;")
+        pycypher.parse_query("RETURN 1;")
+        pycypher.parse_query("RETURN 3;")
+        self.assertIs(pycypher.parse_query("RETURN 1;")[0], first[0])
+        self.assertEqual(pycypher.cache_info().currsize, 2)
+        pycypher.parse_query("RETURN 2;")
+        self.assertEqual(pycypher.cache_info().misses, 4)
+
+    def test_fingerprints(self):
+        pycypher.fingerprint("RETURN 1;")
+        pycypher.fingerprint("RETURN 2;")
+        info = pycypher.cache_info()
+        self.assertEqual((info.currsize, info.shapes), (2, 1))
+        pycypher.fingerprint("RETURN 1;")
+        self.assertEqual(pycypher.cache_info().hits, 1)
+
+    def test_errors_not_cached(self):
+        for _ in range(2):
+            with self.assertRaises(pycypher.CypherParseError):
+                pycypher.parse_query("RETURN 1 +;")
+        self.assertEqual(pycypher.cache_info().currsize, 0)
+
+    def test_disabled(self):
+        pycypher.set_cache_size(0)
+        self.assertIsNone(pycypher.cache_info())
+        a = pycypher.parse_query("RETURN 1;")
+        self.assertIsNot(a[0], pycypher.parse_query("RETURN 1;")[0])
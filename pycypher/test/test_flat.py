@@ -0,0 +1,63 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+class TestFlat(unittest.TestCase):
+    def setUp(self):
+        self.flat = pycypher.parse_query_flat("RETURN 1 AS x;")
+        self.expected_ast_dump = [
+            "@0   0..14  statement           body=@1\n",
+            "@1   0..14  > query             clauses=[@2]\n",
+            "@2   0..13  > > RETURN          projections=[@3]\n",
+            "@3   7..13  > > > projection    expression=@4, alias=@5\n",
+            "@4   7..8   > > > > integer     1\n",
+            "@5  12..13  > > > > identifier  `x`\n",
+        ]
+
+    def test_matches_tree(self):
+        flat = self.flat
+        self.assertEqual(len(flat), 6)
+        self.assertEqual(list(flat.roots), [0])
+        self.assertEqual([flat.type(i) for i in range(len(flat))], [
+            "CYPHER_AST_STATEMENT",
+            "CYPHER_AST_QUERY",
+            "CYPHER_AST_RETURN",
+            "CYPHER_AST_PROJECTION",
+            "CYPHER_AST_INTEGER",
+            "CYPHER_AST_IDENTIFIER",
+        ])
+        self.assertEqual(list(flat.parents), [-1, 0, 1, 2, 3, 3])
+        self.assertEqual(list(flat.children_of(3)), [4, 5])
+        self.assertEqual(list(flat.children_of(4)), [])
+        self.assertEqual(list(flat.starts), [0, 0, 0, 7, 7, 12])
+        self.assertEqual(list(flat.ends), [14, 14, 13, 13, 8, 13])
+        self.assertEqual(flat.string(4), "1")
+        self.assertEqual(flat.string(5), "x")
+        self.assertEqual(flat.string(0), "")
+
+    def test_same_as_tree(self):
+        ast, = pycypher.parse_query("MATCH (n) RETURN n;")
+        flat = pycypher.parse_query_flat("MATCH (n) RETURN n;")
+        nodes = list(ast.find_nodes())
+        self.assertEqual(len(flat), len(nodes))
+        for i, node in enumerate(nodes):
+            self.assertEqual(flat.type(i), node.type)
+            self.assertEqual((flat.starts[i], flat.ends[i]), (node.start, node.end))
+
+    def test_errors(self):
+        with self.assertRaises(pycypher.CypherParseError) as cm:
+            pycypher.parse_query_flat("RETURN 'foo")
+        self.assertEqual(len(cm.exception.parse_result.roots), 1)
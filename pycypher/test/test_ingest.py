@@ -0,0 +1,113 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import io
+import json
+import os
+import shutil
+import tempfile
+import unittest
+import pycypher
+from pycypher import ingest
+
+
+QUERIES = [
+    "MATCH (n) RETURN n;",
+    "RETURN 'foo",
+    "RETURN 1 AS x, 'bar' AS y",
+    "RETURN 2 AS x, 'baz' AS y",
+]
+
+
+class TestIngest(unittest.TestCase):
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        self.path = os.path.join(self.dir, 'log')
+        with open(self.path, 'wb') as f:
+            f.write(('\n'.join(QUERIES) + '\n  \n').encode('utf-8') * 50)
+
+    def tearDown(self):
+        shutil.rmtree(self.dir)
+
+    def test_outcomes(self):
+        outcomes = list(ingest.scan_log(self.path, workers=1))
+        self.assertEqual(len(outcomes), 200)
+        with open(self.path, 'rb') as f:
+            data = f.read()
+        for i, outcome in enumerate(outcomes):
+            query = QUERIES[i % 4]
+            self.assertEqual(
+                data[outcome.offset:outcome.offset + outcome.length],
+                query.encode('utf-8')
+            )
+            validation = pycypher.validate(query)
+            self.assertEqual(outcome.nerrors, len(validation.errors))
+            self.assertEqual(outcome.nnodes, validation.nnodes)
+            if validation.valid:
+                self.assertEqual(outcome.error_offset, -1)
+                self.assertEqual(
+                    outcome.fingerprint, pycypher.fingerprint(query)
+                )
+            else:
+                self.assertEqual(
+                    outcome.error_offset, validation.errors[0].offset
+                )
+        self.assertEqual(outcomes[2].fingerprint, outcomes[3].fingerprint)
+
+    def test_shards_end_on_lines(self):
+        data = b'a\nbb\n\nccc'
+        for shard_size in (0, 1, 2, 3, 100):
+            ranges = ingest.shards(data, shard_size)
+            self.assertEqual(ranges[0][0], 0)
+            self.assertEqual(ranges[-1][1], len(data))
+            for (_, end), (start, _) in zip(ranges, ranges[1:]):
+                self.assertEqual(end, start)
+                self.assertEqual(data[end - 1:end], b'\n')
+
+    def test_workers_match_serial(self):
+        serial = list(ingest.scan_log(self.path, workers=1))
+        for workers in (2, 4):
+            self.assertEqual(
+                list(ingest.scan_log(self.path, workers, shard_size=64)),
+                serial
+            )
+
+    def test_jsonl(self):
+        out = io.BytesIO()
+        ingest.dump_file(self.path, out, 'jsonl', workers=2, shard_size=64)
+        records = [
+            json.loads(line) for line in out.getvalue().decode().splitlines()
+        ]
+        self.assertEqual(len(records), 200)
+        self.assertTrue(records[0]['ok'])
+        self.assertFalse(records[1]['ok'])
+        self.assertIsNone(records[0]['error_offset'])
+        self.assertEqual(records[1]['error_offset'], 11)
+
+    def test_table(self):
+        out = io.BytesIO()
+        ingest.dump_file(self.path, out, 'table', workers=2, shard_size=64)
+        data = out.getvalue()
+        self.assertTrue(data.startswith(ingest.TABLE_MAGIC))
+        size = ingest.TABLE_RECORD.size
+        records = [
+            ingest.TABLE_RECORD.unpack_from(data, offset)
+            for offset in range(len(ingest.TABLE_MAGIC), len(data), size)
+        ]
+        self.assertEqual(
+            records, [tuple(o) for o in ingest.scan_log(self.path, 1)]
+        )
+
+    def test_empty_file(self):
+        with open(self.path, 'wb'):
+            pass
+        self.assertEqual(list(ingest.scan_log(self.path)), [])
@@ -0,0 +1,100 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import sys
+import threading
+import unittest
+import pycypher
+
+try:
+    import _testcapi
+except ImportError:
+    _testcapi = None
+
+
+QUERIES = ["MATCH (n) RETURN n;", "RETURN 1 AS x, 'bar' AS y", "RETURN 'foo"]
+
+
+class TestInterpreters(unittest.TestCase):
+    @unittest.skipUnless(
+        hasattr(_testcapi, 'run_in_subinterp'), 'needs _testcapi'
+    )
+    def test_subinterpreter(self):
+        # The bindings share Python objects process-wide, so only the
+        # interpreter that loaded them first can use them.
+        fingerprint = pycypher.fingerprint(QUERIES[0])
+        code = '\n'.join([
+            'import sys',
+            'sys.path[:] = %r' % sys.path,
+            'try:',
+            '    import pycypher',
+            'except ImportError:',
+            '    pass',
+            'else:',
+            '    raise AssertionError("loaded by a subinterpreter")',
+        ])
+        self.assertEqual(_testcapi.run_in_subinterp(code), 0)
+        self.assertEqual(pycypher.fingerprint(QUERIES[0]), fingerprint)
+
+    def test_threads(self):
+        expected = [
+            (pycypher.validate(query).nnodes, query) for query in QUERIES
+        ]
+        templates = dict(
+            (query, pycypher.extract_literals(query).template)
+            for _, query in expected if pycypher.validate(query).valid
+        )
+        failures = []
+
+        def run():
+            try:
+                for _ in range(50):
+                    for nnodes, query in expected:
+                        if pycypher.validate(query).nnodes != nnodes:
+                            failures.append(query)
+                        if pycypher.validate(query).valid:
+                            pycypher.fingerprint(query)
+                            ast = pycypher.parse_query(query)[0]
+                            ast._role_nodes
+                            if (pycypher.extract_literals(query).template !=
+                                    templates[query]):
+                                failures.append(query)
+            except Exception as e:
+                failures.append(e)
+
+        threads = [threading.Thread(target=run) for _ in range(8)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(failures, [])
+
+    def test_shared_statement_stream(self):
+        query = ' '.join([QUERIES[0]] * 400)
+        stream = pycypher.iter_statements(query)
+        starts = []
+
+        def run():
+            try:
+                for ast, _ in stream:
+                    starts.append(ast.start)
+            except ValueError:
+                # Another thread is parsing the next directive.
+                pass
+
+        threads = [threading.Thread(target=run) for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(len(starts), len(set(starts)))
+        self.assertLessEqual(len(starts), 400)
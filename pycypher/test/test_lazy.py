@@ -0,0 +1,64 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+class TestLazy(unittest.TestCase):
+    queries = [
+        "RETURN 1;",
+        "MATCH (n) RETURN n;",
+        "/* MATCH */ RETURN 1 AS x, 'bar' AS y",
+        "START n = node(*) /* predicate */ WHERE n.foo > 1 RETURN n;",
+    ]
+
+    def test_same_tree_as_eager(self):
+        for query in self.queries:
+            eager = pycypher.parse_query(query)
+            lazy = pycypher.parse_query(query, lazy=True)
+            self.assertEqual(
+                [ast.to_json() for ast in lazy],
+                [ast.to_json() for ast in eager],
+            )
+
+    def test_getters(self):
+        ast, = pycypher.parse_query("RETURN 1 AS x;", lazy=True)
+        self.assertTrue(isinstance(ast, pycypher.LazyCypherAstNode))
+        self.assertTrue(isinstance(ast, pycypher.CypherAstNode))
+        clause = ast.get_body().get_clauses()[0]
+        self.assertEqual(clause.type, "CYPHER_AST_RETURN")
+        self.assertFalse(clause.is_distinct())
+        alias = clause.get_projections()[0].get_alias()
+        self.assertEqual(alias.get_name(), "x")
+        self.assertEqual((alias.start, alias.end), (12, 13))
+
+    def test_only_visited_nodes_are_built(self):
+        ast, = pycypher.parse_query("RETURN 1, 2, 3;", lazy=True)
+        self.assertEqual(ast.type, "CYPHER_AST_STATEMENT")
+        self.assertTrue(ast._lazy_children is None)
+        query = ast.get_body()
+        self.assertTrue(query._lazy_children is None)
+
+    def test_outlives_parent_nodes(self):
+        ast, = pycypher.parse_query("RETURN 1 AS x;", lazy=True)
+        clause = ast.get_body().get_clauses()[0]
+        del ast
+        projection, = clause.get_projections()
+        self.assertEqual(projection.get_alias().get_name(), "x")
+
+    def test_errors(self):
+        with self.assertRaises(pycypher.CypherParseError) as cm:
+            pycypher.parse_query("RETURN 'foo", lazy=True)
+        self.assertEqual(cm.exception.offset, 11)
+        self.assertEqual(len(cm.exception.parse_result), 1)
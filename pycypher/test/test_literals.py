@@ -0,0 +1,75 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+class TestLiterals(unittest.TestCase):
+    def test_extract(self):
+        query = "MATCH (n) RETURN n + 1 AS x, 'a', [2.5, $q, true, null];"
+        literals = pycypher.extract_literals(query)
+        self.assertEqual(
+            [literals.kind(i) for i in range(len(literals))],
+            ['integer', 'string', 'float', 'parameter', 'true', 'null'],
+        )
+        self.assertEqual(
+            [query[literals.starts[i]:literals.ends[i]]
+             for i in range(len(literals))],
+            ['1', "'a'", '2.5', '$q', 'true', 'null'],
+        )
+        self.assertEqual(
+            [literals.value(i) for i in range(len(literals))],
+            [1, 'a', 2.5, 'q', True, None],
+        )
+        self.assertEqual(
+            literals.template,
+            "MATCH (n) RETURN n + $p0 AS x, $p1, [$p2, $q, $p3, $p4];",
+        )
+        self.assertEqual(literals.parameters(), {
+            'p0': 1, 'p1': 'a', 'p2': 2.5, 'p3': True, 'p4': None,
+        })
+
+    def test_same_template(self):
+        a = pycypher.extract_literals("RETURN [1, 'x'] AS l;", prefix='v')
+        b = pycypher.extract_literals("RETURN [22, 'yy'] AS l;", prefix='v')
+        self.assertEqual(a.template, b.template)
+        self.assertEqual(a.template, "RETURN [$v0, $v1] AS l;")
+        self.assertEqual(b.parameters(), {'v0': 22, 'v1': 'yy'})
+
+    def test_not_parameters(self):
+        # Cypher doesn't allow parameters in these places.
+        query = "MATCH (a)-[*1..3]-(b) RETURN a, 4;"
+        literals = pycypher.extract_literals(query)
+        self.assertEqual(
+            literals.template, "MATCH (a)-[*1..3]-(b) RETURN a, $p0;"
+        )
+        self.assertEqual(literals.parameters(), {'p0': 4})
+        query = ("USING PERIODIC COMMIT 500 "
+                 "LOAD CSV FROM 'x.csv' AS l FIELDTERMINATOR ';' RETURN l;")
+        literals = pycypher.extract_literals(query)
+        self.assertEqual(
+            literals.template,
+            "USING PERIODIC COMMIT 500 "
+            "LOAD CSV FROM $p0 AS l FIELDTERMINATOR ';' RETURN l;",
+        )
+        self.assertEqual(literals.parameters(), {'p0': 'x.csv'})
+
+    def test_empty(self):
+        literals = pycypher.extract_literals("MATCH (n) RETURN n;")
+        self.assertEqual(len(literals), 0)
+        self.assertEqual(literals.template, "MATCH (n) RETURN n;")
+
+    def test_errors(self):
+        with self.assertRaises(pycypher.CypherParseError):
+            pycypher.extract_literals("RETURN 1 +;")
@@ -0,0 +1,87 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+QUERY = "MATCH (n) RETURN n + 1 AS x, [2, 3];"
+
+
+class TestMatcher(unittest.TestCase):
+    def match(self, *patterns):
+        return pycypher.Matcher(patterns).match(QUERY)
+
+    def test_types(self):
+        integers, = self.match("INTEGER")
+        self.assertEqual(integers, [
+            ("CYPHER_AST_INTEGER", 21, 22),
+            ("CYPHER_AST_INTEGER", 30, 31),
+            ("CYPHER_AST_INTEGER", 33, 34),
+        ])
+        self.assertEqual(self.match("CYPHER_AST_INTEGER"), [integers])
+        expressions, = self.match("EXPRESSION")
+        ast, = pycypher.parse_query(QUERY)
+        self.assertEqual(
+            [(m.type, m.start, m.end) for m in expressions],
+            [(n.type, n.start, n.end)
+             for n in ast.find_nodes(instanceof="CYPHER_AST_EXPRESSION")],
+        )
+
+    def test_combinators(self):
+        children, descendants, none = self.match(
+            "COLLECTION > INTEGER",
+            "RETURN >> INTEGER",
+            "MATCH >> INTEGER",
+        )
+        self.assertEqual([m.start for m in children], [30, 33])
+        self.assertEqual([m.start for m in descendants], [21, 30, 33])
+        self.assertEqual(none, [])
+        direct, = self.match("PROJECTION > INTEGER")
+        self.assertEqual(direct, [])
+
+    def test_conditions(self):
+        no_limit, limit, skip, plus, name, argument, alias = self.match(
+            "RETURN[!limit]",
+            "RETURN[limit]",
+            "RETURN[distinct=false, !skip]",
+            "BINARY_OPERATOR[operator=PLUS]",
+            "IDENTIFIER[name='x']",
+            "BINARY_OPERATOR > IDENTIFIER[@argument1]",
+            "*[@alias]",
+        )
+        self.assertEqual(len(no_limit), 1)
+        self.assertEqual(limit, [])
+        self.assertEqual(len(skip), 1)
+        self.assertEqual([m.start for m in plus], [17])
+        self.assertEqual([m.start for m in name], [26])
+        self.assertEqual([m.start for m in argument], [17])
+        self.assertEqual([m.start for m in alias], [26, 29])
+
+    def test_invalid(self):
+        for pattern in ["", "NOPE", "MATCH >", "MATCH[", "RETURN[a b]",
+                        "IDENTIFIER[name='x]", "MATCH < RETURN"]:
+            with self.assertRaises(ValueError):
+                pycypher.Matcher([pattern])
+
+    def test_parser_options(self):
+        matcher = pycypher.Matcher(["INTEGER"])
+        integers, = pycypher.Parser(initial_offset=100).match(matcher, QUERY)
+        self.assertEqual([m.start for m in integers], [121, 130, 133])
+        self.assertEqual(
+            pycypher.Parser().match(matcher, QUERY), matcher.match(QUERY)
+        )
+
+    def test_errors(self):
+        with self.assertRaises(pycypher.CypherParseError):
+            pycypher.Matcher(["RETURN"]).match("RETURN 1 +;")
@@ -0,0 +1,84 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+import gc
+import unittest
+import weakref
+import pycypher
+from pycypher import bindings
+
+
+QUERY = "MATCH (n) RETURN n + 1 AS x, [1, 2] AS l;"
+
+
+class TestNavigation(unittest.TestCase):
+    def assertNavigable(self, roots):
+        ids = []
+        for root in roots:
+            self.assertIsNone(root.parent)
+            self.assertEqual(root.depth, 0)
+            for node in root.traverse():
+                ids.append(node.id)
+                for child in node.children:
+                    self.assertIs(child.parent, node)
+                    self.assertEqual(child.depth, node.depth + 1)
+        self.assertEqual(ids, list(range(len(ids))))
+
+    def test_ordinals(self):
+        self.assertNavigable(pycypher.parse_query(QUERY))
+        self.assertNavigable(pycypher.parse_query("RETURN 1; RETURN 2;"))
+
+    def test_lazy(self):
+        self.assertNavigable(pycypher.parse_query(QUERY, lazy=True))
+
+    def test_loaded(self):
+        self.assertNavigable(
+            pycypher.load_query(pycypher.dump_query("RETURN 1; RETURN 2;"))
+        )
+
+    def test_python_construction(self):
+        def build(*args):
+            return pycypher.CypherAstNode(*args)
+        roots = bindings.parse_query(build, pycypher.CypherParseError, QUERY)
+        self.assertNavigable(roots[0])
+
+    def test_enclosing(self):
+        ast, = pycypher.parse_query(QUERY)
+        x = next(ast.find_nodes(type='CYPHER_AST_IDENTIFIER', role='alias'))
+        self.assertEqual(x.get_name(), 'x')
+        ret = x.enclosing(type='CYPHER_AST_RETURN')
+        self.assertEqual(ret.type, 'CYPHER_AST_RETURN')
+        self.assertIs(x.enclosing(instanceof='CYPHER_AST_QUERY_CLAUSE'), ret)
+        self.assertIsNone(x.enclosing(type='CYPHER_AST_MATCH'))
+        self.assertEqual(
+            [node.type for node in x.ancestors()],
+            ['CYPHER_AST_PROJECTION', 'CYPHER_AST_RETURN',
+             'CYPHER_AST_QUERY', 'CYPHER_AST_STATEMENT'],
+        )
+        self.assertIs(list(x.ancestors())[-1], ast)
+
+    def test_outlives_root(self):
+        for lazy in (False, True):
+            x = next(pycypher.parse_query(QUERY, lazy=lazy)[0].find_nodes(
+                type='CYPHER_AST_IDENTIFIER', role='alias'
+            ))
+            gc.collect()
+            self.assertEqual(
+                x.enclosing(type='CYPHER_AST_RETURN').type, 'CYPHER_AST_RETURN'
+            )
+            self.assertEqual(len(list(x.ancestors())), 4)
+            root = weakref.ref(list(x.ancestors())[-1])
+            del x
+            gc.collect()
+            self.assertIsNone(root())
@@ -0,0 +1,107 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import io
+import os
+import shutil
+import tempfile
+import unittest
+import pycypher
+
+
+QUERY = "MATCH (n) RETURN n + 1 AS x;"
+
+
+class TestParseBuffer(unittest.TestCase):
+    def assertParsed(self, result):
+        ast, = result
+        self.assertEqual(ast.type, "CYPHER_AST_STATEMENT")
+        self.assertEqual((ast.start, ast.end), (0, len(QUERY)))
+
+    def test_types(self):
+        data = QUERY.encode('utf-8')
+        self.assertParsed(pycypher.parse_buffer(data))
+        self.assertParsed(pycypher.parse_buffer(bytearray(data)))
+        self.assertParsed(pycypher.parse_buffer(memoryview(data)))
+
+    def test_slice(self):
+        data = memoryview(b"xx" + QUERY.encode('utf-8') + b"yy")
+        self.assertParsed(pycypher.parse_buffer(data[2:-2]))
+
+    def test_embedded_nul(self):
+        # The input isn't cut at the NUL, so whatever follows it is either
+        # parsed or reported.
+        try:
+            result = pycypher.parse_buffer(b"RETURN 1;\0RETURN 2;")
+        except pycypher.CypherParseError as e:
+            self.assertGreaterEqual(e.offset, 9)
+        else:
+            self.assertGreater(result[-1].end, 9)
+
+    def test_errors(self):
+        with self.assertRaises(pycypher.CypherParseError):
+            pycypher.parse_buffer(b"RETURN 1 +;")
+
+
+class TestParseFile(unittest.TestCase):
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        self.path = os.path.join(self.dir, 'query.cyp')
+        with open(self.path, 'wb') as f:
+            f.write(QUERY.encode('utf-8'))
+
+    def tearDown(self):
+        shutil.rmtree(self.dir)
+
+    def test_path(self):
+        ast, = pycypher.parse_file(self.path)
+        self.assertEqual((ast.start, ast.end), (0, len(QUERY)))
+
+    def test_file_object(self):
+        with open(self.path, 'rb') as f:
+            ast, = pycypher.parse_file(f)
+        self.assertEqual((ast.start, ast.end), (0, len(QUERY)))
+
+    def test_bytes_io(self):
+        ast, = pycypher.parse_file(io.BytesIO(QUERY.encode('utf-8')))
+        self.assertEqual((ast.start, ast.end), (0, len(QUERY)))
+
+    def test_position(self):
+        # The whole file is parsed and its position left as is.
+        with open(self.path, 'rb') as f:
+            f.read(5)
+            ast, = pycypher.parse_file(f)
+            self.assertEqual(f.tell(), 5)
+        self.assertEqual((ast.start, ast.end), (0, len(QUERY)))
+        f = io.BytesIO(QUERY.encode('utf-8'))
+        f.read(5)
+        ast, = pycypher.parse_file(f)
+        self.assertEqual(f.tell(), 5)
+        self.assertEqual((ast.start, ast.end), (0, len(QUERY)))
+
+    def test_empty(self):
+        path = os.path.join(self.dir, 'empty.cyp')
+        open(path, 'wb').close()
+        self.assertEqual(pycypher.parse_file(path), [])
+
+    def test_pipe(self):
+        read_fd, write_fd = os.pipe()
+        os.write(write_fd, QUERY.encode('utf-8'))
+        os.close(write_fd)
+        with os.fdopen(read_fd, 'rb') as f:
+            ast, = pycypher.parse_file(f)
+        self.assertEqual((ast.start, ast.end), (0, len(QUERY)))
+
+    def test_missing(self):
+        with self.assertRaises(OSError):
+            pycypher.parse_file(os.path.join(self.dir, 'missing.cyp'))
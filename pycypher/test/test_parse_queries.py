@@ -0,0 +1,72 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import threading
+import unittest
+import pycypher
+
+
+class TestParseQueries(unittest.TestCase):
+    def test_results_in_input_order(self):
+        queries = ["RETURN %d;" % i for i in range(100)]
+        results = pycypher.parse_queries(queries, workers=4)
+        self.assertEqual(len(results), 100)
+        for i, result in enumerate(results):
+            self.assertEqual(len(result), 1)
+            clause = result[0].get_body().get_clauses()[0]
+            expression = clause.get_projections()[0].get_expression()
+            self.assertEqual(expression.get_valuestr(), str(i))
+
+    def test_errors_are_returned(self):
+        ok, failed = pycypher.parse_queries(["RETURN 1;", "RETURN 'foo"])
+        self.assertEqual(ok[0].type, "CYPHER_AST_STATEMENT")
+        self.assertTrue(isinstance(failed, pycypher.CypherParseError))
+        self.assertEqual(failed.offset, 11)
+        self.assertEqual(len(failed.all_errors), 1)
+        self.assertEqual(len(failed.parse_result), 1)
+
+    def test_matches_parse_query(self):
+        queries = ["MATCH (n) RETURN n;", "RETURN 1 AS x, 'bar' AS y"]
+        for workers in (None, 1, 2, 8):
+            results = pycypher.parse_queries(queries, workers=workers)
+            self.assertEqual(
+                [[ast.to_json() for ast in result] for result in results],
+                [
+                    [ast.to_json() for ast in pycypher.parse_query(query)]
+                    for query in queries
+                ],
+            )
+
+    def test_empty(self):
+        self.assertEqual(pycypher.parse_queries([]), [])
+
+    def test_list_changed_while_parsing(self):
+        # The queries are snapshotted, so replacing the items of the list
+        # while the workers parse doesn't free strings they are reading.
+        queries = ["RETURN %d;" % i for i in range(200)]
+        done = threading.Event()
+
+        def mutate():
+            while not done.is_set():
+                for i in range(len(queries)):
+                    queries[i] = "RETURN %d;" % -i
+
+        thread = threading.Thread(target=mutate)
+        thread.start()
+        try:
+            for _ in range(5):
+                results = pycypher.parse_queries(queries, workers=4)
+                self.assertEqual(len(results), 200)
+        finally:
+            done.set()
+            thread.join()
@@ -0,0 +1,72 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+SCRIPT = "MATCH (n) RETURN n;\nRETURN 1 AS x;\nRETURN [2, 3] AS y;\n"
+
+
+def directives(script):
+    return [
+        (ast.to_json() if ast is not None else None,
+         [(e.message, e.offset) for e in errors])
+        for ast, errors in script.directives()
+    ]
+
+
+def fresh(text):
+    return directives(pycypher.ParsedScript(text))
+
+
+class TestParsedScript(unittest.TestCase):
+    def test_parse(self):
+        script = pycypher.ParsedScript(SCRIPT)
+        self.assertEqual(len(script.asts), 3)
+        self.assertEqual(script.errors, [])
+        self.assertEqual(script.text, SCRIPT)
+
+    def test_edit_reuses_following_directives(self):
+        script = pycypher.ParsedScript(SCRIPT)
+        last = script.asts[2]
+        offset = SCRIPT.index('1 AS x')
+        self.assertEqual(script.edit(offset, 1, '42'), 1)
+        text = SCRIPT.replace('1 AS x', '42 AS x')
+        self.assertEqual(script.text, text)
+        self.assertEqual(directives(script), fresh(text))
+        self.assertIs(script.asts[2], last)
+        self.assertEqual(last.start, text.index('RETURN [2'))
+
+    def test_edit_merging_directives(self):
+        script = pycypher.ParsedScript(SCRIPT)
+        offset = SCRIPT.index(';')
+        script.edit(offset, 1, '')
+        text = SCRIPT.replace(';', '', 1)
+        self.assertEqual(directives(script), fresh(text))
+        script.edit(offset, 0, ';')
+        self.assertEqual(directives(script), fresh(SCRIPT))
+        self.assertEqual(script.errors, [])
+
+    def test_edit_at_end(self):
+        script = pycypher.ParsedScript(SCRIPT)
+        self.assertEqual(script.edit(len(SCRIPT), 0, 'RETURN 4 AS z;'), 1)
+        self.assertEqual(len(script.asts), 4)
+        self.assertEqual(
+            directives(script), fresh(SCRIPT + 'RETURN 4 AS z;')
+        )
+
+    def test_edit_out_of_range(self):
+        script = pycypher.ParsedScript(SCRIPT)
+        with self.assertRaises(ValueError):
+            script.edit(len(SCRIPT), 1, '')
@@ -0,0 +1,65 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+class TestParser(unittest.TestCase):
+    def test_defaults(self):
+        parser = pycypher.Parser()
+        for query in ["RETURN 1;", "MATCH (n) RETURN n;"]:
+            ast, = parser.parse_query(query)
+            expected, = pycypher.parse_query(query)
+            self.assertEqual(ast.to_json(), expected.to_json())
+
+    def test_initial_offset(self):
+        parser = pycypher.Parser(initial_offset=100)
+        ast, = parser.parse_query("RETURN 1;")
+        self.assertEqual((ast.start, ast.end), (100, 109))
+        with self.assertRaises(pycypher.CypherParseError) as e:
+            parser.parse_query("RETURN 1 +;")
+        self.assertEqual(e.exception.offset, 110)
+
+    def test_other_inputs(self):
+        parser = pycypher.Parser(initial_offset=10)
+        self.assertEqual(parser.parse_buffer(b"RETURN 1;")[0].start, 10)
+        self.assertEqual(parser.parse_query_flat("RETURN 1;").starts[0], 10)
+        self.assertEqual(parser.parse_query("RETURN 1;", lazy=True)[0].start, 10)
+        result, = parser.parse_queries(["RETURN 1;"])
+        self.assertEqual(result[0].start, 10)
+
+    def test_iter_statements(self):
+        parser = pycypher.Parser(initial_offset=10, initial_line=3)
+        query = "RETURN 1; RETURN 2 +;"
+        (first, errors), (second, more_errors) = parser.iter_statements(query)
+        self.assertEqual(errors, [])
+        parsed = parser.parse_query("RETURN 1;")[0]
+        self.assertEqual((first.start, first.end), (parsed.start, parsed.end))
+        with self.assertRaises(pycypher.CypherParseError) as e:
+            parser.parse_query(query)
+        self.assertEqual(more_errors[0].offset, e.exception.offset)
+
+    def test_iter_statements_single(self):
+        parser = pycypher.Parser(single=True)
+        streamed = list(parser.iter_statements("RETURN 1; RETURN 2;"))
+        self.assertEqual(len(streamed), len(parser.parse_query("RETURN 1; RETURN 2;")))
+
+    def test_only_statements(self):
+        parser = pycypher.Parser(only_statements=True)
+        for ast in parser.parse_query("RETURN 1;"):
+            self.assertEqual(ast.type, "CYPHER_AST_STATEMENT")
+
+    def test_invalid(self):
+        with self.assertRaises(ValueError):
+            pycypher.Parser(initial_offset=-1)
@@ -0,0 +1,80 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+def without_ids(value):
+    if isinstance(value, list):
+        return [without_ids(v) for v in value]
+    if isinstance(value, dict) and 'id' in value:
+        return value['role']
+    return value
+
+
+class TestSerialize(unittest.TestCase):
+    def assertSameTree(self, a, b):
+        self.assertEqual(a.type, b.type)
+        self.assertEqual(sorted(a._instanceof), sorted(b._instanceof))
+        self.assertEqual((a.start, a.end), (b.start, b.end))
+        self.assertEqual(
+            dict((k, without_ids(v)) for k, v in a._props.items()),
+            dict((k, without_ids(v)) for k, v in b._props.items()),
+        )
+        self.assertEqual(a._roles, b._roles)
+        self.assertEqual(len(a.children), len(b.children))
+        for x, y in zip(a.children, b.children):
+            self.assertSameTree(x, y)
+
+    def test_round_trip(self):
+        query = "MATCH (n) RETURN n + 1 AS x, 'a', [1, $p], true;"
+        parsed = pycypher.parse_query(query)
+        loaded = pycypher.load_query(pycypher.dump_query(query))
+        self.assertEqual(len(parsed), len(loaded))
+        for a, b in zip(parsed, loaded):
+            self.assertSameTree(a, b)
+
+    def test_getters(self):
+        ast, = pycypher.load_query(pycypher.dump_query("RETURN 1 AS x;"))
+        projection = ast.get_body().get_clauses()[0].get_projections()[0]
+        self.assertEqual(projection.get_alias().get_name(), "x")
+        self.assertEqual(projection.get_expression().get_valuestr(), "1")
+
+    def test_errors(self):
+        blob = pycypher.dump_query("RETURN 1 +;")
+        with self.assertRaises(pycypher.CypherParseError) as loaded:
+            pycypher.load_query(blob)
+        with self.assertRaises(pycypher.CypherParseError) as parsed:
+            pycypher.parse_query("RETURN 1 +;")
+        self.assertEqual(loaded.exception.message, parsed.exception.message)
+        self.assertEqual(loaded.exception.offset, parsed.exception.offset)
+
+    def test_corrupt(self):
+        blob = pycypher.dump_query("RETURN 1;")
+        with self.assertRaises(ValueError):
+            pycypher.load_query(b"nope")
+        with self.assertRaises(ValueError):
+            pycypher.load_query(blob[:-1])
+        with self.assertRaises(ValueError):
+            pycypher.load_query(blob[:4] + b"\xff" + blob[5:])
+
+    def test_too_deep(self):
+        # One type named "x", no errors, and one root whose only descendant
+        # chain is far deeper than the loader accepts.
+        depth = 1000000
+        blob = b"PCYA\x01" + b"\x01\x01x" + b"\x01\x00\x00" + b"\x00\x01"
+        blob += b"\x00\x00\x00\x01" * depth + b"\x00\x00\x00\x00"
+        blob += b"\x00" * (depth + 1)
+        with self.assertRaises(ValueError):
+            pycypher.load_query(blob)
@@ -0,0 +1,73 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+class TestStats(unittest.TestCase):
+    def setUp(self):
+        self.was_enabled = pycypher.enable_stats()
+        pycypher.reset_stats()
+
+    def tearDown(self):
+        pycypher.enable_stats(self.was_enabled)
+        pycypher.reset_stats()
+
+    def test_parse_query(self):
+        query = "MATCH (n) RETURN n;"
+        ast, = pycypher.parse_query(query)
+        stats = pycypher.stats()
+        self.assertEqual(stats['parses'], 1)
+        self.assertEqual(stats['bytes_parsed'], len(query))
+        self.assertEqual(stats['builds'], 1)
+        self.assertEqual(stats['nodes_built'], len(list(ast.find_nodes())))
+        self.assertEqual(stats['errors_built'], 0)
+        self.assertGreaterEqual(stats['build_ns'], stats['init_ns'])
+        self.assertEqual(
+            stats['convert_ns'], stats['build_ns'] - stats['init_ns']
+        )
+
+    def test_objects_allocated(self):
+        ast, = pycypher.parse_query("MATCH (n) RETURN n;")
+        stats = pycypher.stats()
+        # Every node has a children tuple besides itself.
+        self.assertGreaterEqual(
+            stats['objects_allocated'], 2 * stats['nodes_built']
+        )
+        if isinstance(ast, pycypher.bindings.AstNode):
+            self.assertEqual(stats['init_ns'], 0)
+        pycypher.reset_stats()
+        pycypher.validate("MATCH (n) RETURN n;")
+        self.assertEqual(pycypher.stats()['objects_allocated'], 0)
+
+    def test_errors_and_validate(self):
+        pycypher.validate("RETURN 1 +;")
+        stats = pycypher.stats()
+        self.assertEqual(stats['parses'], 1)
+        self.assertEqual(stats['builds'], 0)
+        self.assertGreater(stats['errors_built'], 0)
+
+    def test_statement_stream(self):
+        list(pycypher.iter_statements("RETURN 1 AS x; RETURN 2 AS y;"))
+        stats = pycypher.stats()
+        self.assertGreaterEqual(stats['parses'], 2)
+        self.assertEqual(stats['builds'], 2)
+
+    def test_reset_and_disable(self):
+        pycypher.validate("RETURN 1;")
+        pycypher.reset_stats()
+        self.assertEqual(set(pycypher.stats().values()), {0})
+        self.assertTrue(pycypher.enable_stats(False))
+        pycypher.validate("RETURN 1;")
+        self.assertEqual(pycypher.stats()['parses'], 0)
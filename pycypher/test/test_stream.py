@@ -0,0 +1,91 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import io
+import os
+import shutil
+import tempfile
+import unittest
+import pycypher
+
+
+SCRIPT = "RETURN 1;\nMATCH (n) RETURN n;\nRETURN 'a' AS b;\n"
+
+
+class TestIterStatements(unittest.TestCase):
+    def test_matches_parse_query(self):
+        streamed = list(pycypher.iter_statements(SCRIPT))
+        parsed = pycypher.parse_query(SCRIPT)
+        self.assertEqual(len(streamed), 3)
+        for (ast, errors), expected in zip(streamed, parsed):
+            self.assertEqual(errors, [])
+            self.assertEqual(ast.type, expected.type)
+            self.assertEqual((ast.start, ast.end), (expected.start, expected.end))
+            self.assertEqual(
+                [node.type for node in ast.find_nodes()],
+                [node.type for node in expected.find_nodes()],
+            )
+
+    def test_lazy(self):
+        statements = pycypher.iter_statements(SCRIPT)
+        ast, errors = next(statements)
+        self.assertEqual((ast.start, ast.end), (0, 9))
+        ast, errors = next(statements)
+        self.assertEqual(ast.start, 10)
+
+    def test_errors(self):
+        results = list(pycypher.iter_statements("RETURN 1 +;\nRETURN 2;"))
+        self.assertTrue(results[0][1])
+        self.assertIsInstance(results[0][1][0], pycypher.CypherParseError)
+        self.assertEqual(results[0][1][0].offset, 10)
+        ast, errors = results[-1]
+        self.assertEqual(errors, [])
+        self.assertEqual(ast.start, 12)
+
+    def test_empty(self):
+        self.assertEqual(list(pycypher.iter_statements("")), [])
+        self.assertEqual(list(pycypher.iter_statements(b"  \n")), [])
+
+
+class TestIterFile(unittest.TestCase):
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        self.path = os.path.join(self.dir, 'script.cyp')
+        with open(self.path, 'wb') as f:
+            f.write(SCRIPT.encode('utf-8'))
+
+    def tearDown(self):
+        shutil.rmtree(self.dir)
+
+    def assertStatements(self, statements):
+        starts = [ast.start for ast, errors in statements]
+        self.assertEqual(starts, [0, 10, 30])
+
+    def test_path(self):
+        self.assertStatements(pycypher.iter_file(self.path))
+
+    def test_file_object(self):
+        with open(self.path, 'rb') as f:
+            statements = pycypher.iter_file(f)
+        # The mapping outlives the file.
+        self.assertStatements(statements)
+
+    def test_bytes_io(self):
+        self.assertStatements(
+            pycypher.iter_file(io.BytesIO(SCRIPT.encode('utf-8')))
+        )
+
+    def test_empty(self):
+        path = os.path.join(self.dir, 'empty.cyp')
+        open(path, 'wb').close()
+        self.assertEqual(list(pycypher.iter_file(path)), [])
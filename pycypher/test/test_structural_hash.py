@@ -0,0 +1,87 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+class TestStructuralHash(unittest.TestCase):
+    def test_same_query(self):
+        a, = pycypher.parse_query("MATCH (n) RETURN n + 1 AS x;")
+        b, = pycypher.parse_query("MATCH  (n)  RETURN n+1  AS  x ;")
+        self.assertEqual(hash(a), hash(b))
+        self.assertEqual(a, b)
+        self.assertFalse(a != b)
+
+    def test_different_literal(self):
+        a, = pycypher.parse_query("RETURN 1 AS x;")
+        b, = pycypher.parse_query("RETURN 2 AS x;")
+        self.assertNotEqual(a, b)
+        self.assertNotEqual(a, None)
+
+    def test_hash_collision(self):
+        a, = pycypher.parse_query("RETURN 1 AS x;")
+        b, = pycypher.parse_query("RETURN 2 AS x;")
+        c, = pycypher.parse_query("RETURN 2 AS x;")
+        # Make the roots collide; their children still tell them apart.
+        a._hash = b._hash = c._hash = 42
+        self.assertEqual(hash(a), hash(b))
+        self.assertNotEqual(a, b)
+        self.assertEqual(b, c)
+        self.assertEqual(len(set([a, b, c])), 2)
+        x = next(a.find_nodes(type='CYPHER_AST_INTEGER'))
+        y = next(b.find_nodes(type='CYPHER_AST_INTEGER'))
+        x._hash = y._hash = 7
+        self.assertNotEqual(x, y)
+
+    def test_roles(self):
+        skip, = pycypher.parse_query("RETURN n SKIP 5;")
+        limit, = pycypher.parse_query("RETURN n LIMIT 5;")
+        self.assertNotEqual(hash(skip), hash(limit))
+        self.assertNotEqual(skip, limit)
+        skip._hash = limit._hash = 42
+        self.assertNotEqual(skip, limit)
+
+    def test_range_bounds(self):
+        a, = pycypher.parse_query("MATCH (a)-[*2..]-(b) RETURN a;")
+        b, = pycypher.parse_query("MATCH (a)-[*..2]-(b) RETURN a;")
+        self.assertNotEqual(a, b)
+        x = next(a.find_nodes(type='CYPHER_AST_RANGE'))
+        y = next(b.find_nodes(type='CYPHER_AST_RANGE'))
+        self.assertNotEqual(hash(x), hash(y))
+        self.assertNotEqual(x, y)
+
+    def test_subexpressions(self):
+        ast, = pycypher.parse_query("MATCH (a) RETURN a + 1 AS x, a + 1 AS y;")
+        ops = list(ast.find_nodes(type='CYPHER_AST_BINARY_OPERATOR'))
+        self.assertEqual(len(ops), 2)
+        self.assertEqual(ops[0], ops[1])
+        self.assertNotEqual(ops[0].start, ops[1].start)
+        self.assertEqual(len(set(ops)), 1)
+
+    def test_other_builds(self):
+        query = "MATCH (n) RETURN n + 'y' AS x, [1, true] SKIP 1;"
+        ast, = pycypher.parse_query(query)
+        loaded, = pycypher.load_query(pycypher.dump_query(query))
+        lazy, = pycypher.parse_query(query, lazy=True)
+        self.assertEqual(hash(loaded), hash(ast))
+        self.assertEqual(hash(lazy), hash(ast))
+        # The copy gives the children the same roles through AST props.
+        props = dict(ast.props)
+        for role, nodes in ast._role_nodes.items():
+            props['_' + role] = [{'id': n.id, 'role': role} for n in nodes]
+        copy = pycypher.CypherAstNode(
+            ast.id, ast.type, ast._instanceof, ast.children, props,
+            ast.start, ast.end
+        )
+        self.assertEqual(hash(copy), hash(ast))
@@ -0,0 +1,95 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+QUERY = "MATCH (n) RETURN n + 1 AS x, [2, 3];"
+
+
+def preorder(node):
+    yield node
+    for child in node.children:
+        for d in preorder(child):
+            yield d
+
+
+def postorder(node):
+    for child in node.children:
+        for d in postorder(child):
+            yield d
+    yield node
+
+
+class TestTraverse(unittest.TestCase):
+    def setUp(self):
+        self.ast, = pycypher.parse_query(QUERY)
+
+    def test_orders(self):
+        self.assertEqual(self.ast.traverse(), list(preorder(self.ast)))
+        self.assertEqual(
+            self.ast.traverse(order='post'), list(postorder(self.ast))
+        )
+        with self.assertRaises(ValueError):
+            self.ast.traverse(order='in')
+
+    def test_filters(self):
+        integers = self.ast.traverse(type="CYPHER_AST_INTEGER")
+        self.assertEqual([n.get_valuestr() for n in integers], ["1", "2", "3"])
+        expressions = self.ast.traverse(instanceof="CYPHER_AST_EXPRESSION")
+        self.assertEqual(expressions, [
+            n for n in preorder(self.ast)
+            if n.instanceof("CYPHER_AST_EXPRESSION")
+        ])
+        aliases = self.ast.traverse(role="alias")
+        self.assertEqual([n.get_name() for n in aliases], ["x", "[2, 3]"])
+        in_range = self.ast.traverse(start=17, end=22)
+        self.assertEqual(
+            [(n.start, n.end) for n in in_range],
+            [(17, 22), (17, 18), (21, 22)],
+        )
+
+    def test_prune(self):
+        pruned = self.ast.traverse(
+            type="CYPHER_AST_INTEGER",
+            prune=lambda n: n.type == "CYPHER_AST_COLLECTION",
+        )
+        self.assertEqual([n.get_valuestr() for n in pruned], ["1"])
+
+    def test_callback(self):
+        seen = []
+        count = self.ast.traverse(
+            type="CYPHER_AST_INTEGER", callback=seen.append
+        )
+        self.assertEqual(count, 3)
+        self.assertEqual(len(seen), 3)
+        count = self.ast.traverse(
+            type="CYPHER_AST_INTEGER", callback=lambda n: True
+        )
+        self.assertEqual(count, 1)
+
+    def test_errors_propagate(self):
+        def fail(node):
+            raise KeyError()
+        with self.assertRaises(KeyError):
+            self.ast.traverse(callback=fail)
+        with self.assertRaises(KeyError):
+            self.ast.traverse(prune=fail)
+
+    def test_lazy(self):
+        lazy, = pycypher.parse_query(QUERY, lazy=True)
+        self.assertEqual(
+            [(n.type, n.start) for n in lazy.traverse(role="alias")],
+            [(n.type, n.start) for n in self.ast.traverse(role="alias")],
+        )
@@ -0,0 +1,44 @@
+# Copyright 2017, Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import pycypher
+
+
+class TestValidate(unittest.TestCase):
+    def test_valid(self):
+        query = "MATCH (n) RETURN n; RETURN 1;"
+        result = pycypher.validate(query)
+        self.assertTrue(result.valid)
+        self.assertEqual(result.errors, [])
+        self.assertEqual(result.ndirectives, 2)
+        nodes = sum(
+            len(list(ast.find_nodes()))
+            for ast in pycypher.parse_query(query)
+        )
+        self.assertEqual(result.nnodes, nodes)
+
+    def test_invalid(self):
+        result = pycypher.validate("RETURN 1 +;")
+        self.assertFalse(result.valid)
+        with self.assertRaises(pycypher.CypherParseError) as e:
+            pycypher.parse_query("RETURN 1 +;")
+        error = result.errors[0]
+        self.assertIsInstance(error, pycypher.CypherParseError)
+        self.assertEqual(error.message, e.exception.message)
+        self.assertEqual(error.offset, e.exception.offset)
+        self.assertEqual(error.context, e.exception.context)
+
+    def test_parser(self):
+        result = pycypher.Parser(initial_offset=5).validate("RETURN 1 +;")
+        self.assertEqual(result.errors[0].offset, 15)
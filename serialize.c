@@ -0,0 +1,814 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdint.h>
+#include "serialize.h"
+#include "parser.h"
+#include "ptr_map.h"
+
+#if PY_MAJOR_VERSION >= 3
+  #define PYCYPHER_BLOB_FORMAT "y*"
+  #define PYCYPHER_BYTES_FROM_STRING_AND_SIZE PyBytes_FromStringAndSize
+  #define PYCYPHER_STRING_FROM_UTF8(s, n) PyUnicode_DecodeUTF8(s, n, NULL)
+  #define PYCYPHER_INTERN_STRING PyUnicode_InternFromString
+#else
+  #define PYCYPHER_BLOB_FORMAT "s*"
+  #define PYCYPHER_BYTES_FROM_STRING_AND_SIZE PyString_FromStringAndSize
+  #define PYCYPHER_STRING_FROM_UTF8(s, n) PyString_FromStringAndSize(s, n)
+  #define PYCYPHER_INTERN_STRING PyString_InternFromString
+#endif
+
+typedef struct {
+  unsigned char* data;
+  size_t len;
+  size_t capacity;
+  bool failed;
+}
+pycypher_buffer_t;
+
+static void pycypher_buffer_put(pycypher_buffer_t* buffer, const void* data, size_t len) {
+  if(buffer->failed)
+    return;
+  if(buffer->len + len > buffer->capacity) {
+    size_t capacity = buffer->capacity ? buffer->capacity : 256;
+    while(capacity < buffer->len + len)
+      capacity *= 2;
+    unsigned char* resized = realloc(buffer->data, capacity);
+    if(resized == NULL) {
+      buffer->failed = true;
+      return;
+    }
+    buffer->data = resized;
+    buffer->capacity = capacity;
+  }
+  memcpy(buffer->data + buffer->len, data, len);
+  buffer->len += len;
+}
+
+static void pycypher_buffer_put_byte(pycypher_buffer_t* buffer, unsigned char byte) {
+  pycypher_buffer_put(buffer, &byte, 1);
+}
+
+static void pycypher_buffer_put_varint(pycypher_buffer_t* buffer, uint64_t value) {
+  unsigned char bytes[10];
+  size_t n = 0;
+  do {
+    bytes[n] = value & 0x7f;
+    value >>= 7;
+    if(value)
+      bytes[n] |= 0x80;
+    ++n;
+  } while(value);
+  pycypher_buffer_put(buffer, bytes, n);
+}
+
+static void pycypher_buffer_put_string(pycypher_buffer_t* buffer, const char* s) {
+  size_t len = s == NULL ? 0 : strlen(s);
+  pycypher_buffer_put_varint(buffer, len);
+  pycypher_buffer_put(buffer, s, len);
+}
+
+typedef struct {
+  pycypher_buffer_t names;
+  size_t nnames;
+  // Names are static strings from the tables, so they are deduplicated by
+  // their address.
+  pycypher_ptr_map_t name_refs;
+  pycypher_buffer_t types;
+  size_t ntypes;
+  int type_refs[PYCYPHER_NODE_TYPES_CAPACITY];
+  pycypher_buffer_t nodes;
+  pycypher_ptr_map_t ordinals;
+  size_t next_ordinal;
+  size_t depth;
+  bool dangling_ref;
+  bool too_deep;
+}
+pycypher_serializer_t;
+
+static size_t pycypher_serialized_name(pycypher_serializer_t* s, const char* name) {
+  size_t ref;
+  if(!pycypher_ptr_map_get(&s->name_refs, name, &ref)) {
+    ref = s->nnames++;
+    pycypher_ptr_map_put(&s->name_refs, name, ref);
+    pycypher_buffer_put_string(&s->names, name);
+  }
+  return ref;
+}
+
+static size_t pycypher_serialized_type(
+  pycypher_serializer_t* s, const cypher_astnode_t* src_ast
+) {
+  cypher_astnode_type_t type = cypher_astnode_type(src_ast);
+  if(s->type_refs[type] < 0) {
+    const char* name = "CYPHER_AST_UNKNOWN";
+    size_t ninstanceof = 0;
+    size_t i;
+    for(i=0; i<pycypher_node_types_len; ++i) {
+      if(pycypher_node_types[i].node_type == type)
+        name = pycypher_node_types[i].name;
+      if(cypher_astnode_instanceof(src_ast, pycypher_node_types[i].node_type))
+        ++ninstanceof;
+    }
+    s->type_refs[type] = s->ntypes++;
+    pycypher_buffer_put_varint(&s->types, pycypher_serialized_name(s, name));
+    pycypher_buffer_put_varint(&s->types, ninstanceof);
+    for(i=0; i<pycypher_node_types_len; ++i)
+      if(cypher_astnode_instanceof(src_ast, pycypher_node_types[i].node_type))
+        pycypher_buffer_put_varint(&s->types, pycypher_serialized_name(
+          s, pycypher_node_types[i].name
+        ));
+  }
+  return s->type_refs[type];
+}
+
+static void pycypher_serialize_node_ref(
+  pycypher_serializer_t* s, size_t ordinal, const cypher_astnode_t* target
+) {
+  size_t target_ordinal;
+  // Props only ever refer to descendants, which are already numbered.
+  if(!pycypher_ptr_map_get(&s->ordinals, target, &target_ordinal) ||
+      target_ordinal <= ordinal) {
+    s->dangling_ref = true;
+    target_ordinal = ordinal;
+  }
+  pycypher_buffer_put_varint(&s->nodes, target_ordinal - ordinal);
+}
+
+/* Return whether the prop would be put into the dict by
+pycypher_extract_props.
+*/
+static bool pycypher_serialized_prop_present(
+  const cypher_astnode_t* src_ast, const pycypher_prop_ref_t* ref
+) {
+  switch(ref->kind) {
+    case PYCYPHER_STRING_PROP:
+      return ((const pycypher_string_prop_t*)ref->prop)->getter(src_ast) != NULL;
+    case PYCYPHER_AST_PROP:
+      return ((const pycypher_ast_prop_t*)ref->prop)->getter(src_ast) != NULL;
+    default:
+      return true;
+  }
+}
+
+static void pycypher_serialize_prop(
+  pycypher_serializer_t* s, const cypher_astnode_t* src_ast, size_t ordinal,
+  const pycypher_prop_ref_t* ref
+) {
+  pycypher_buffer_t* out = &s->nodes;
+  unsigned int n;
+  unsigned int i;
+  pycypher_buffer_put_varint(out, pycypher_serialized_name(
+    s, pycypher_prop_ref_name(ref)
+  ));
+  switch(ref->kind) {
+    case PYCYPHER_DIRECTION_PROP: {
+      const pycypher_direction_prop_t* prop = ref->prop;
+      pycypher_buffer_put_byte(out, PYCYPHER_SERIALIZED_NAME);
+      pycypher_buffer_put_varint(out, pycypher_serialized_name(
+        s, pycypher_direction_name(prop->getter(src_ast))
+      ));
+      break;
+    }
+    case PYCYPHER_OPERATOR_PROP: {
+      const pycypher_operator_prop_t* prop = ref->prop;
+      pycypher_buffer_put_byte(out, PYCYPHER_SERIALIZED_NAME);
+      pycypher_buffer_put_varint(out, pycypher_serialized_name(
+        s, pycypher_operator_name(prop->getter(src_ast))
+      ));
+      break;
+    }
+    case PYCYPHER_OPERATOR_LIST_PROP: {
+      const pycypher_operator_list_prop_t* prop = ref->prop;
+      n = prop->length_getter(src_ast);
+      pycypher_buffer_put_byte(out, PYCYPHER_SERIALIZED_NAME_LIST);
+      pycypher_buffer_put_varint(out, n);
+      for(i=0; i<n; ++i)
+        pycypher_buffer_put_varint(out, pycypher_serialized_name(
+          s, pycypher_operator_name(prop->list_getter(src_ast, i))
+        ));
+      break;
+    }
+    case PYCYPHER_BOOL_PROP: {
+      const pycypher_bool_prop_t* prop = ref->prop;
+      pycypher_buffer_put_byte(out, prop->getter(src_ast)
+        ? PYCYPHER_SERIALIZED_TRUE
+        : PYCYPHER_SERIALIZED_FALSE
+      );
+      break;
+    }
+    case PYCYPHER_STRING_PROP: {
+      const pycypher_string_prop_t* prop = ref->prop;
+      pycypher_buffer_put_byte(out, PYCYPHER_SERIALIZED_STRING);
+      pycypher_buffer_put_string(out, prop->getter(src_ast));
+      break;
+    }
+    case PYCYPHER_AST_LIST_PROP: {
+      const pycypher_ast_list_prop_t* prop = ref->prop;
+      n = prop->length_getter(src_ast);
+      pycypher_buffer_put_byte(out, PYCYPHER_SERIALIZED_NODE_LIST);
+      pycypher_buffer_put_varint(out, pycypher_serialized_name(s, prop->role));
+      pycypher_buffer_put_varint(out, n);
+      for(i=0; i<n; ++i)
+        pycypher_serialize_node_ref(s, ordinal, prop->list_getter(src_ast, i));
+      break;
+    }
+    case PYCYPHER_AST_LIST_PLUS_ONE_PROP: {
+      const pycypher_ast_list_plus_one_prop_t* prop = ref->prop;
+      n = prop->length_getter(src_ast) + 1;
+      pycypher_buffer_put_byte(out, PYCYPHER_SERIALIZED_NODE_LIST);
+      pycypher_buffer_put_varint(out, pycypher_serialized_name(s, prop->role));
+      pycypher_buffer_put_varint(out, n);
+      for(i=0; i<n; ++i)
+        pycypher_serialize_node_ref(s, ordinal, prop->list_getter(src_ast, i));
+      break;
+    }
+    case PYCYPHER_AST_PROP: {
+      const pycypher_ast_prop_t* prop = ref->prop;
+      pycypher_buffer_put_byte(out, PYCYPHER_SERIALIZED_NODE);
+      pycypher_buffer_put_varint(out, pycypher_serialized_name(s, prop->name));
+      pycypher_serialize_node_ref(s, ordinal, prop->getter(src_ast));
+      break;
+    }
+  }
+}
+
+static int pycypher_serialize_node(
+  pycypher_serializer_t* s, const cypher_astnode_t* src_ast
+) {
+  size_t ordinal = s->next_ordinal++;
+  unsigned int nchildren = cypher_astnode_nchildren(src_ast);
+  struct cypher_input_range range = cypher_astnode_range(src_ast);
+  const pycypher_prop_plan_t* plan = pycypher_get_prop_plan(src_ast);
+  size_t nprops = 0;
+  size_t i;
+  if(plan == NULL)
+    return -1;
+
+  pycypher_ptr_map_put(&s->ordinals, src_ast, ordinal);
+  pycypher_buffer_put_varint(&s->nodes, pycypher_serialized_type(s, src_ast));
+  pycypher_buffer_put_varint(&s->nodes, range.start.offset);
+  pycypher_buffer_put_varint(&s->nodes, range.end.offset);
+  pycypher_buffer_put_varint(&s->nodes, nchildren);
+  if(nchildren > 0 && s->depth >= PYCYPHER_SERIALIZED_MAX_DEPTH) {
+    s->too_deep = true;
+    return -1;
+  }
+  ++s->depth;
+  for(i=0; i<nchildren; ++i)
+    if(pycypher_serialize_node(s, cypher_astnode_get_child(src_ast, i)) < 0)
+      return -1;
+  --s->depth;
+
+  for(i=0; i<plan->len; ++i)
+    if(pycypher_serialized_prop_present(src_ast, &plan->refs[i]))
+      ++nprops;
+  pycypher_buffer_put_varint(&s->nodes, nprops);
+  for(i=0; i<plan->len; ++i)
+    if(pycypher_serialized_prop_present(src_ast, &plan->refs[i]))
+      pycypher_serialize_prop(s, src_ast, ordinal, &plan->refs[i]);
+  return 0;
+}
+
+static size_t pycypher_count_names(void) {
+  // Every name comes from one of the tables; prop tables contribute names and
+  // roles, and there are four direction names.
+  return pycypher_node_types_len + pycypher_operators_len + 1 + 4 +
+    pycypher_direction_props_len + pycypher_operator_props_len +
+    pycypher_operator_list_props_len + pycypher_bool_props_len +
+    pycypher_string_props_len + 2 * pycypher_ast_list_props_len +
+    2 * pycypher_ast_list_plus_one_props_len + pycypher_ast_props_len;
+}
+
+PyObject* pycypher_serialize_parse_result(const cypher_parse_result_t* parse_result) {
+  pycypher_serializer_t s;
+  pycypher_buffer_t header;
+  unsigned int nroots = cypher_parse_result_nroots(parse_result);
+  unsigned int nerrors = cypher_parse_result_nerrors(parse_result);
+  size_t nnodes = 0;
+  PyObject* result = NULL;
+  unsigned int i;
+
+  memset(&s, 0, sizeof(s));
+  memset(&header, 0, sizeof(header));
+  for(i=0; i<PYCYPHER_NODE_TYPES_CAPACITY; ++i)
+    s.type_refs[i] = -1;
+  for(i=0; i<nroots; ++i)
+    nnodes += pycypher_count_nodes(cypher_parse_result_get_root(parse_result, i));
+  if(pycypher_ptr_map_init(&s.name_refs, pycypher_count_names()) < 0 ||
+      pycypher_ptr_map_init(&s.ordinals, nnodes) < 0) {
+    PyErr_NoMemory();
+    goto cleanup;
+  }
+
+  pycypher_buffer_put_varint(&s.nodes, nroots);
+  for(i=0; i<nroots; ++i)
+    if(pycypher_serialize_node(
+        &s, cypher_parse_result_get_root(parse_result, i)
+    ) < 0) {
+      if(s.too_deep)
+        PyErr_SetString(PyExc_ValueError, "AST too deeply nested to serialize");
+      else
+        PyErr_NoMemory();
+      goto cleanup;
+    }
+  if(s.dangling_ref) {
+    PyErr_SetString(PyExc_ValueError, "AST prop refers to a non-descendant node");
+    goto cleanup;
+  }
+
+  pycypher_buffer_put(&header, PYCYPHER_SERIALIZED_MAGIC, 4);
+  pycypher_buffer_put_byte(&header, PYCYPHER_SERIALIZED_VERSION);
+  pycypher_buffer_put_varint(&header, s.nnames);
+  pycypher_buffer_put(&header, s.names.data, s.names.len);
+  pycypher_buffer_put_varint(&header, s.ntypes);
+  pycypher_buffer_put(&header, s.types.data, s.types.len);
+  pycypher_buffer_put_varint(&header, nerrors);
+  for(i=0; i<nerrors; ++i) {
+    const cypher_parse_error_t* err = cypher_parse_result_get_error(parse_result, i);
+    pycypher_buffer_put_string(&header, cypher_parse_error_message(err));
+    pycypher_buffer_put_string(&header, cypher_parse_error_context(err));
+    pycypher_buffer_put_varint(&header, cypher_parse_error_position(err).offset);
+    pycypher_buffer_put_varint(&header, cypher_parse_error_context_offset(err));
+  }
+  pycypher_buffer_put(&header, s.nodes.data, s.nodes.len);
+  if(header.failed || s.names.failed || s.types.failed || s.nodes.failed) {
+    PyErr_NoMemory();
+    goto cleanup;
+  }
+  result = PYCYPHER_BYTES_FROM_STRING_AND_SIZE(
+    (const char*)header.data, header.len
+  );
+
+cleanup:
+  pycypher_ptr_map_free(&s.name_refs);
+  pycypher_ptr_map_free(&s.ordinals);
+  free(s.names.data);
+  free(s.types.data);
+  free(s.nodes.data);
+  free(header.data);
+  return result;
+}
+
+PyObject* pycypher_dump_query(PyObject* self, PyObject* args) {
+  char* query;
+  if (!PyArg_ParseTuple(args, "s:dump_query", &query))
+    return NULL;
+  const pycypher_parser_options_t* options = pycypher_parser_options(self);
+  cypher_parse_result_t* parse_result;
+  Py_BEGIN_ALLOW_THREADS
+  parse_result = pycypher_invoke_parser(options, query, strlen(query));
+  Py_END_ALLOW_THREADS
+  if(parse_result == NULL)
+    return PyErr_SetFromErrno(PyExc_OSError);
+  PyObject* result = pycypher_serialize_parse_result(parse_result);
+  cypher_parse_result_free(parse_result);
+  return result;
+}
+
+typedef struct {
+  const unsigned char* pos;
+  const unsigned char* end;
+  PyObject* names;
+  PyObject* type_names;
+  PyObject* type_instanceof;
+  size_t next_ordinal;
+  pycypher_build_ctx_t ctx;
+}
+pycypher_loader_t;
+
+static int pycypher_corrupt_blob(void) {
+  PyErr_SetString(PyExc_ValueError, "Corrupt serialized AST");
+  return -1;
+}
+
+static int pycypher_read_varint(pycypher_loader_t* l, size_t* value) {
+  uint64_t result = 0;
+  unsigned int shift = 0;
+  for(;;) {
+    if(l->pos >= l->end || shift > 63)
+      return pycypher_corrupt_blob();
+    unsigned char byte = *l->pos++;
+    result |= (uint64_t)(byte & 0x7f) << shift;
+    if(!(byte & 0x80))
+      break;
+    shift += 7;
+  }
+  *value = result;
+  return 0;
+}
+
+static int pycypher_read_count(pycypher_loader_t* l, size_t* value) {
+  // Every counted item takes at least one byte, which bounds allocations
+  // made for corrupt counts.
+  if(pycypher_read_varint(l, value) < 0)
+    return -1;
+  if(*value > (size_t)(l->end - l->pos))
+    return pycypher_corrupt_blob();
+  return 0;
+}
+
+static PyObject* pycypher_read_string(pycypher_loader_t* l) {
+  size_t len;
+  if(pycypher_read_count(l, &len) < 0)
+    return NULL;
+  PyObject* result = PYCYPHER_STRING_FROM_UTF8((const char*)l->pos, len);
+  l->pos += len;
+  return result;
+}
+
+/* Return a borrowed reference to the name. */
+static PyObject* pycypher_read_name(pycypher_loader_t* l) {
+  size_t ref;
+  if(pycypher_read_varint(l, &ref) < 0)
+    return NULL;
+  if(ref >= (size_t)PyList_GET_SIZE(l->names)) {
+    pycypher_corrupt_blob();
+    return NULL;
+  }
+  return PyList_GET_ITEM(l->names, ref);
+}
+
+static PyObject* pycypher_load_node_ref(
+  pycypher_loader_t* l, size_t ordinal, PyObject* role
+) {
+  size_t distance;
+  if(pycypher_read_varint(l, &distance) < 0)
+    return NULL;
+  if(distance == 0 || distance >= l->next_ordinal - ordinal) {
+    pycypher_corrupt_blob();
+    return NULL;
+  }
+  return pycypher_stats_allocated(Py_BuildValue(
+    "{s:n,s:O}", "id", (Py_ssize_t)(ordinal + distance), "role", role
+  ));
+}
+
+static PyObject* pycypher_load_prop(pycypher_loader_t* l, size_t ordinal) {
+  PyObject* role;
+  PyObject* result;
+  size_t n;
+  size_t i;
+  if(l->pos >= l->end) {
+    pycypher_corrupt_blob();
+    return NULL;
+  }
+  switch(*l->pos++) {
+    case PYCYPHER_SERIALIZED_FALSE:
+      Py_RETURN_FALSE;
+    case PYCYPHER_SERIALIZED_TRUE:
+      Py_RETURN_TRUE;
+    case PYCYPHER_SERIALIZED_STRING:
+      return pycypher_read_string(l);
+    case PYCYPHER_SERIALIZED_NAME:
+      result = pycypher_read_name(l);
+      Py_XINCREF(result);
+      return result;
+    case PYCYPHER_SERIALIZED_NAME_LIST:
+      if(pycypher_read_count(l, &n) < 0)
+        return NULL;
+      result = pycypher_stats_allocated(PyList_New(n));
+      for(i=0; result != NULL && i<n; ++i) {
+        PyObject* name = pycypher_read_name(l);
+        if(name == NULL) {
+          Py_CLEAR(result);
+          break;
+        }
+        Py_INCREF(name);
+        PyList_SET_ITEM(result, i, name);
+      }
+      return result;
+    case PYCYPHER_SERIALIZED_NODE:
+      if((role = pycypher_read_name(l)) == NULL)
+        return NULL;
+      return pycypher_load_node_ref(l, ordinal, role);
+    case PYCYPHER_SERIALIZED_NODE_LIST:
+      if((role = pycypher_read_name(l)) == NULL ||
+          pycypher_read_count(l, &n) < 0)
+        return NULL;
+      result = pycypher_stats_allocated(PyList_New(n));
+      for(i=0; result != NULL && i<n; ++i) {
+        PyObject* ref = pycypher_load_node_ref(l, ordinal, role);
+        if(ref == NULL) {
+          Py_CLEAR(result);
+          break;
+        }
+        PyList_SET_ITEM(result, i, ref);
+      }
+      return result;
+  }
+  pycypher_corrupt_blob();
+  return NULL;
+}
+
+typedef struct {
+  size_t ordinal;
+  Py_hash_t hash;
+  uint64_t roles;
+}
+pycypher_loaded_child_t;
+
+/* Add the role of a {"id", "role"} dict to the child it refers to, if it is
+one of the n children, which are in the order of their ordinals.
+*/
+static int pycypher_hash_loaded_role(
+  pycypher_loaded_child_t* children, size_t n, PyObject* ref
+) {
+  PyObject* id = PyDict_GetItemString(ref, "id");
+  PyObject* role = PyDict_GetItemString(ref, "role");
+  if(id == NULL || role == NULL)
+    return 0;
+  size_t ordinal = PyLong_AsSize_t(id);
+  if(ordinal == (size_t)-1 && PyErr_Occurred())
+    return -1;
+  size_t lo = 0;
+  size_t hi = n;
+  while(lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if(children[mid].ordinal < ordinal)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if(lo == n || children[lo].ordinal != ordinal)
+    return 0;
+  return pycypher_hash_role(&children[lo].roles, role);
+}
+
+/* Fold the hashes of the children and the roles the AST props give them into
+a children hash, as pycypher_build_ast_children does.
+*/
+static int pycypher_hash_loaded_children(
+  pycypher_loaded_child_t* children, size_t n, PyObject* props,
+  uint64_t* children_hash
+) {
+  PyObject* name;
+  PyObject* value;
+  Py_ssize_t pos = 0;
+  Py_ssize_t j;
+  size_t i;
+  while(PyDict_Next(props, &pos, &name, &value)) {
+    if(PyDict_Check(value)) {
+      if(pycypher_hash_loaded_role(children, n, value) < 0)
+        return -1;
+    } else if(PyList_Check(value)) {
+      for(j=0; j<PyList_GET_SIZE(value); ++j) {
+        PyObject* item = PyList_GET_ITEM(value, j);
+        if(PyDict_Check(item) &&
+            pycypher_hash_loaded_role(children, n, item) < 0)
+          return -1;
+      }
+    }
+  }
+  *children_hash = PYCYPHER_HASH_SEED;
+  for(i=0; i<n; ++i)
+    *children_hash = pycypher_hash_child(
+      *children_hash, children[i].hash, children[i].roles
+    );
+  return 0;
+}
+
+static PyObject* pycypher_load_node(pycypher_loader_t* l, Py_hash_t* hash) {
+  size_t ordinal = l->next_ordinal++;
+  size_t type, start, end, nchildren, nprops;
+  size_t i;
+  if(pycypher_read_varint(l, &type) < 0 ||
+      pycypher_read_varint(l, &start) < 0 ||
+      pycypher_read_varint(l, &end) < 0 ||
+      pycypher_read_count(l, &nchildren) < 0)
+    return NULL;
+  if(type >= (size_t)PyList_GET_SIZE(l->type_names)) {
+    pycypher_corrupt_blob();
+    return NULL;
+  }
+
+  if(nchildren > 0 && l->ctx.depth >= PYCYPHER_SERIALIZED_MAX_DEPTH) {
+    pycypher_corrupt_blob();
+    return NULL;
+  }
+  PyObject* children = pycypher_stats_allocated(PyTuple_New(nchildren));
+  if(children == NULL)
+    return NULL;
+  // nchildren is bounded by the size of the blob, see pycypher_read_count.
+  pycypher_loaded_child_t* loaded = malloc(
+    (nchildren ? nchildren : 1) * sizeof(*loaded)
+  );
+  if(loaded == NULL) {
+    Py_DECREF(children);
+    PyErr_NoMemory();
+    return NULL;
+  }
+  ++l->ctx.depth;
+  for(i=0; i<nchildren; ++i) {
+    loaded[i].ordinal = l->next_ordinal;
+    loaded[i].roles = 0;
+    PyObject* child = pycypher_load_node(l, &loaded[i].hash);
+    if(child == NULL) {
+      free(loaded);
+      Py_DECREF(children);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(children, i, child);
+  }
+  --l->ctx.depth;
+
+  uint64_t children_hash;
+  PyObject* props = pycypher_stats_allocated(PyDict_New());
+  if(props == NULL || pycypher_read_count(l, &nprops) < 0) {
+    free(loaded);
+    Py_DECREF(children);
+    Py_XDECREF(props);
+    return NULL;
+  }
+  for(i=0; i<nprops; ++i) {
+    PyObject* name = pycypher_read_name(l);
+    PyObject* value = name == NULL ? NULL : pycypher_load_prop(l, ordinal);
+    if(value == NULL || PyDict_SetItem(props, name, value) < 0) {
+      Py_XDECREF(value);
+      free(loaded);
+      Py_DECREF(children);
+      Py_DECREF(props);
+      return NULL;
+    }
+    Py_DECREF(value);
+  }
+  int hashed = pycypher_hash_loaded_children(
+    loaded, nchildren, props, &children_hash
+  );
+  free(loaded);
+  if(hashed < 0 || pycypher_hash_node(
+      children_hash, nchildren, PyList_GET_ITEM(l->type_names, type), props,
+      hash
+  ) < 0) {
+    Py_DECREF(children);
+    Py_DECREF(props);
+    return NULL;
+  }
+
+  PyObject* id = Py_BuildValue("n", (Py_ssize_t)ordinal);
+  if(id == NULL) {
+    Py_DECREF(children);
+    Py_DECREF(props);
+    return NULL;
+  }
+  PyObject* result = pycypher_build_node(
+    &l->ctx, id, PyList_GET_ITEM(l->type_names, type),
+    PyList_GET_ITEM(l->type_instanceof, type), children, props,
+    (Py_ssize_t)start, (Py_ssize_t)end, *hash
+  );
+  Py_DECREF(id);
+  return result;
+}
+
+static int pycypher_load_tables(pycypher_loader_t* l) {
+  size_t n, ninstanceof;
+  size_t i, j;
+  if(pycypher_read_count(l, &n) < 0 || (l->names = PyList_New(n)) == NULL)
+    return -1;
+  for(i=0; i<n; ++i) {
+    size_t len;
+    if(pycypher_read_count(l, &len) < 0)
+      return -1;
+    // Names are few and shared by many nodes, intern them like the names
+    // passed by the parser.
+    char* name = malloc(len + 1);
+    if(name == NULL) {
+      PyErr_NoMemory();
+      return -1;
+    }
+    memcpy(name, l->pos, len);
+    name[len] = '\0';
+    l->pos += len;
+    PyObject* interned = PYCYPHER_INTERN_STRING(name);
+    free(name);
+    if(interned == NULL)
+      return -1;
+    PyList_SET_ITEM(l->names, i, interned);
+  }
+
+  if(pycypher_read_count(l, &n) < 0 ||
+      (l->type_names = PyList_New(n)) == NULL ||
+      (l->type_instanceof = PyList_New(n)) == NULL)
+    return -1;
+  for(i=0; i<n; ++i) {
+    PyObject* name = pycypher_read_name(l);
+    if(name == NULL)
+      return -1;
+    Py_INCREF(name);
+    PyList_SET_ITEM(l->type_names, i, name);
+    if(pycypher_read_count(l, &ninstanceof) < 0)
+      return -1;
+    PyObject* instanceof = PyTuple_New(ninstanceof);
+    if(instanceof == NULL)
+      return -1;
+    PyList_SET_ITEM(l->type_instanceof, i, instanceof);
+    for(j=0; j<ninstanceof; ++j) {
+      if((name = pycypher_read_name(l)) == NULL)
+        return -1;
+      Py_INCREF(name);
+      PyTuple_SET_ITEM(instanceof, j, name);
+    }
+  }
+  return 0;
+}
+
+static PyObject* pycypher_load_errors(pycypher_loader_t* l, PyObject* exn_class) {
+  size_t n;
+  size_t i;
+  if(pycypher_read_count(l, &n) < 0)
+    return NULL;
+  PyObject* result = PyList_New(n);
+  for(i=0; result != NULL && i<n; ++i) {
+    PyObject* message = pycypher_read_string(l);
+    PyObject* context = message == NULL ? NULL : pycypher_read_string(l);
+    size_t offset, context_offset;
+    PyObject* exn = NULL;
+    if(context != NULL &&
+        pycypher_read_varint(l, &offset) == 0 &&
+        pycypher_read_varint(l, &context_offset) == 0)
+      exn = PyObject_CallFunction(
+        exn_class, "OOnn", message, context,
+        (Py_ssize_t)offset, (Py_ssize_t)context_offset
+      );
+    Py_XDECREF(message);
+    Py_XDECREF(context);
+    if(exn == NULL)
+      Py_CLEAR(result);
+    else
+      PyList_SET_ITEM(result, i, exn);
+  }
+  return result;
+}
+
+PyObject* pycypher_load_query(PyObject* self, PyObject* args) {
+  PyObject* ast_class;
+  PyObject* exn_class;
+  Py_buffer blob;
+  pycypher_loader_t l;
+  PyObject* ast_list = NULL;
+  PyObject* exn_list = NULL;
+  size_t nroots;
+  size_t i;
+  if (!PyArg_ParseTuple(
+      args, "OO" PYCYPHER_BLOB_FORMAT ":load_query", &ast_class, &exn_class, &blob
+  ))
+    return NULL;
+
+  memset(&l, 0, sizeof(l));
+  l.pos = blob.buf;
+  l.end = l.pos + blob.len;
+  l.ctx.cls = ast_class;
+  if(blob.len < 5 || memcmp(l.pos, PYCYPHER_SERIALIZED_MAGIC, 4) != 0) {
+    pycypher_corrupt_blob();
+    goto cleanup;
+  }
+  if(l.pos[4] != PYCYPHER_SERIALIZED_VERSION) {
+    PyErr_Format(
+      PyExc_ValueError, "Unsupported serialized AST version %d", l.pos[4]
+    );
+    goto cleanup;
+  }
+  l.pos += 5;
+  if(pycypher_load_tables(&l) < 0 ||
+      (exn_list = pycypher_load_errors(&l, exn_class)) == NULL ||
+      (l.ctx.index = PyDict_New()) == NULL ||
+      pycypher_read_count(&l, &nroots) < 0 ||
+      (ast_list = PyList_New(nroots)) == NULL)
+    goto cleanup;
+  for(i=0; i<nroots; ++i) {
+    Py_hash_t hash;
+    PyObject* ast = pycypher_load_node(&l, &hash);
+    if(ast == NULL) {
+      Py_CLEAR(ast_list);
+      goto cleanup;
+    }
+    PyList_SET_ITEM(ast_list, i, ast);
+  }
+  if(l.pos != l.end) {
+    pycypher_corrupt_blob();
+    Py_CLEAR(ast_list);
+  }
+
+cleanup:
+  PyBuffer_Release(&blob);
+  Py_XDECREF(l.names);
+  Py_XDECREF(l.type_names);
+  Py_XDECREF(l.type_instanceof);
+  Py_XDECREF(l.ctx.index);
+  if(ast_list == NULL) {
+    Py_XDECREF(exn_list);
+    return NULL;
+  }
+  return Py_BuildValue("(NN)", ast_list, exn_list);
+}
@@ -0,0 +1,60 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_SERIALIZE_H
+#define PYCYPHER_SERIALIZE_H
+#include <Python.h>
+#include <cypher-parser.h>
+
+/* Compact binary format of a parse result. All integers are unsigned LEB128
+varints, strings are a varint length followed by UTF-8 bytes:
+
+  "PCYA" version:u8
+  nnames, names...        all type, prop, role, operator and direction names
+  ntypes, types...        name_ref, ninstanceof, instanceof name_refs...
+  nerrors, errors...      message, context, offset, context_offset
+  nroots, nodes...
+
+where a node is
+
+  type_ref start end nchildren nodes... nprops props...
+
+and a prop is name_ref kind:u8 followed by a kind specific payload, see
+pycypher_serialized_prop_kind_t. Nodes are numbered in pre-order and refer to
+their descendants by the difference of their numbers.
+*/
+#define PYCYPHER_SERIALIZED_MAGIC "PCYA"
+#define PYCYPHER_SERIALIZED_VERSION 1
+/* Both the dumper and the loader recurse once per level of nesting, deeper
+trees are refused so that a crafted blob cannot exhaust the C stack. */
+#define PYCYPHER_SERIALIZED_MAX_DEPTH 10000
+
+typedef enum {
+  PYCYPHER_SERIALIZED_FALSE = 0,      /* no payload */
+  PYCYPHER_SERIALIZED_TRUE = 1,       /* no payload */
+  PYCYPHER_SERIALIZED_STRING = 2,     /* string */
+  PYCYPHER_SERIALIZED_NAME = 3,       /* name_ref */
+  PYCYPHER_SERIALIZED_NAME_LIST = 4,  /* n name_refs... */
+  PYCYPHER_SERIALIZED_NODE = 5,       /* role_ref distance */
+  PYCYPHER_SERIALIZED_NODE_LIST = 6   /* role_ref n distances... */
+}
+pycypher_serialized_prop_kind_t;
+
+/* Return the parse result serialized into a new bytes object. */
+PyObject* pycypher_serialize_parse_result(const cypher_parse_result_t*);
+
+PyObject* pycypher_dump_query(PyObject*, PyObject*);
+PyObject* pycypher_load_query(PyObject*, PyObject*);
+
+#endif
@@ -21,10 +21,25 @@ bindings = Extension(
     sources=[
         'bindings.c',
         'node_types.c',
+        'node_type_info.c',
         'operators.c',
         'props.c',
         'extract_props.c',
         'parser.c',
+        'parser_options.c',
+        'lazy.c',
+        'flat.c',
+        'serialize.c',
+        'ptr_map.c',
+        'fingerprint.c',
+        'ingest.c',
+        'stream.c',
+        'traverse.c',
+        'matcher.c',
+        'literals.c',
+        'structural_hash.c',
+        'stats.c',
+        'ast_node.c',
     ],
     libraries=['cypher-parser'],
 )
@@ -73,4 +88,7 @@ setup(
     include_package_data=True,
     zip_safe=False,
     install_requires=[],
+    entry_points={
+        'console_scripts': ['pycypher-ingest = pycypher.ingest:main'],
+    },
 )
@@ -0,0 +1,101 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <time.h>
+#include "stats.h"
+
+int pycypher_stats_enabled = 0;
+
+static uint64_t pycypher_stats[PYCYPHER_NSTATS];
+
+static const char* pycypher_stat_names[PYCYPHER_NSTATS] = {
+  "parses",
+  "bytes_parsed",
+  "parse_ns",
+  "builds",
+  "nodes_built",
+  "errors_built",
+  "build_ns",
+  "init_ns",
+  "objects_allocated",
+};
+
+uint64_t pycypher_stats_clock(void) {
+  if(!__atomic_load_n(&pycypher_stats_enabled, __ATOMIC_RELAXED))
+    return 0;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+void pycypher_stats_add(pycypher_stat_t stat, uint64_t value) {
+  if(__atomic_load_n(&pycypher_stats_enabled, __ATOMIC_RELAXED))
+    __atomic_fetch_add(&pycypher_stats[stat], value, __ATOMIC_RELAXED);
+}
+
+void pycypher_stats_add_time(pycypher_stat_t stat, uint64_t start) {
+  if(start != 0)
+    pycypher_stats_add(stat, pycypher_stats_clock() - start);
+}
+
+void pycypher_stats_parsed(uint64_t start, size_t length) {
+  if(start == 0)
+    return;
+  pycypher_stats_add_time(PYCYPHER_STAT_PARSE_NS, start);
+  pycypher_stats_add(PYCYPHER_STAT_PARSES, 1);
+  pycypher_stats_add(PYCYPHER_STAT_BYTES_PARSED, length);
+}
+
+PyObject* pycypher_stats_allocated(PyObject* object) {
+  if(object != NULL)
+    pycypher_stats_add(PYCYPHER_STAT_OBJECTS_ALLOCATED, 1);
+  return object;
+}
+
+PyObject* pycypher_get_stats(PyObject* self, PyObject* unused) {
+  PyObject* result = PyDict_New();
+  uint64_t values[PYCYPHER_NSTATS];
+  int i;
+  if(result == NULL)
+    return NULL;
+  for(i=0; i<PYCYPHER_NSTATS; ++i)
+    values[i] = __atomic_load_n(&pycypher_stats[i], __ATOMIC_RELAXED);
+  for(i=0; i<PYCYPHER_NSTATS; ++i) {
+    PyObject* value = PyLong_FromUnsignedLongLong(values[i]);
+    if(value == NULL ||
+        PyDict_SetItemString(result, pycypher_stat_names[i], value) < 0) {
+      Py_XDECREF(value);
+      Py_DECREF(result);
+      return NULL;
+    }
+    Py_DECREF(value);
+  }
+  return result;
+}
+
+PyObject* pycypher_reset_stats(PyObject* self, PyObject* unused) {
+  int i;
+  for(i=0; i<PYCYPHER_NSTATS; ++i)
+    __atomic_store_n(&pycypher_stats[i], 0, __ATOMIC_RELAXED);
+  Py_RETURN_NONE;
+}
+
+PyObject* pycypher_enable_stats(PyObject* self, PyObject* args) {
+  int enabled;
+  if (!PyArg_ParseTuple(args, "i:enable_stats", &enabled))
+    return NULL;
+  return PyBool_FromLong(__atomic_exchange_n(
+    &pycypher_stats_enabled, enabled != 0, __ATOMIC_RELAXED
+  ));
+}
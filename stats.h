@@ -0,0 +1,71 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_STATS_H
+#define PYCYPHER_STATS_H
+#include <stdint.h>
+#include <stddef.h>
+#include <Python.h>
+
+/* Process-wide counters of the work done by the bindings, off by default.
+Counters are updated atomically, so they can be updated with or without the
+GIL, from any thread. Timers are in nanoseconds of the monotonic clock:
+
+ - parse: time spent in the native parser, for every parse and every
+   directive of a statement stream
+ - build: time spent turning native trees into CypherAstNode trees, which
+   includes init
+ - init: time spent creating nodes, in CypherAstNode.__init__ for node
+   classes not derived from the native AstNode. Stays 0 when nodes are built
+   natively, the time being part of build only.
+ - objects allocated: nodes and the props dicts, lists and tuples allocated
+   for them, see pycypher_stats_allocated
+*/
+typedef enum {
+  PYCYPHER_STAT_PARSES,
+  PYCYPHER_STAT_BYTES_PARSED,
+  PYCYPHER_STAT_PARSE_NS,
+  PYCYPHER_STAT_BUILDS,
+  PYCYPHER_STAT_NODES_BUILT,
+  PYCYPHER_STAT_ERRORS_BUILT,
+  PYCYPHER_STAT_BUILD_NS,
+  PYCYPHER_STAT_INIT_NS,
+  PYCYPHER_STAT_OBJECTS_ALLOCATED,
+  PYCYPHER_NSTATS
+}
+pycypher_stat_t;
+
+extern int pycypher_stats_enabled;
+
+/* Return the monotonic clock in nanoseconds if stats are enabled, or 0 so
+that timers can be skipped with a single test.
+*/
+uint64_t pycypher_stats_clock(void);
+void pycypher_stats_add(pycypher_stat_t, uint64_t value);
+/* Add the time elapsed since start, a value of pycypher_stats_clock, unless
+it's 0.
+*/
+void pycypher_stats_add_time(pycypher_stat_t, uint64_t start);
+/* Record a parse of length bytes which started at start. */
+void pycypher_stats_parsed(uint64_t start, size_t length);
+/* Count the object as allocated unless it's NULL, and return it. Temporary
+objects aren't counted.
+*/
+PyObject* pycypher_stats_allocated(PyObject*);
+
+PyObject* pycypher_get_stats(PyObject*, PyObject*);
+PyObject* pycypher_reset_stats(PyObject*, PyObject*);
+PyObject* pycypher_enable_stats(PyObject*, PyObject*);
+
+#endif
@@ -0,0 +1,281 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "stream.h"
+#include "parser.h"
+#include "parser_options.h"
+
+#if PY_MAJOR_VERSION >= 3
+  #define PYCYPHER_BUFFER_FORMAT "y*"
+#else
+  #define PYCYPHER_BUFFER_FORMAT "s*"
+#endif
+
+static pycypher_StatementStream* pycypher_new_statement_stream(
+  PyObject* ast_class, PyObject* exn_class,
+  const pycypher_parser_options_t* options
+) {
+  pycypher_StatementStream* self = PyObject_New(
+    pycypher_StatementStream, &pycypher_StatementStreamType
+  );
+  if(self == NULL)
+    return NULL;
+  Py_INCREF(ast_class);
+  self->ast_class = ast_class;
+  Py_INCREF(exn_class);
+  self->exn_class = exn_class;
+  self->has_view = false;
+  self->mapping = NULL;
+  self->data = NULL;
+  self->length = 0;
+  self->position = options->initial_position;
+  self->origin = options->initial_position.offset;
+  self->flags = options->flags;
+  self->busy = false;
+  self->done = false;
+  self->config = cypher_parser_new_config();
+  if(self->config == NULL) {
+    Py_DECREF(self);
+    return (pycypher_StatementStream*)PyErr_NoMemory();
+  }
+  cypher_parser_config_set_error_colorization(
+    self->config, options->error_colorization
+  );
+  return self;
+}
+
+static void pycypher_StatementStream_dealloc(pycypher_StatementStream* self) {
+  Py_DECREF(self->ast_class);
+  Py_DECREF(self->exn_class);
+  if(self->has_view)
+    PyBuffer_Release(&self->view);
+  if(self->mapping != NULL)
+    munmap(self->mapping, self->length);
+  if(self->config != NULL)
+    cypher_parser_config_free(self->config);
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static int pycypher_take_segment(void* userdata, cypher_parse_segment_t* segment) {
+  cypher_parse_segment_retain(segment);
+  *(cypher_parse_segment_t**)userdata = segment;
+  // Stop after the first segment, the next step picks up where it ended.
+  return 1;
+}
+
+/* Parse the next segment of the input. Doesn't need the GIL. Return NULL with
+errno set on failure.
+*/
+static cypher_parse_segment_t* pycypher_next_segment(pycypher_StatementStream* self) {
+  cypher_parse_segment_t* segment = NULL;
+  size_t offset = self->position.offset - self->origin;
+  uint64_t start = pycypher_stats_clock();
+  // Offsets reported by the parser continue from the previous segment.
+  cypher_parser_config_set_initial_position(self->config, self->position);
+  if(cypher_uparse_each(
+      self->data + offset, self->length - offset, pycypher_take_segment,
+      &segment, NULL, self->config, self->flags
+  ) < 0 && segment == NULL)
+    return NULL;
+  if(segment == NULL) {
+    errno = EIO;
+    return NULL;
+  }
+  size_t end = cypher_parse_segment_get_range(segment).end.offset - self->origin;
+  pycypher_stats_parsed(start, end > offset ? end - offset : 0);
+  return segment;
+}
+
+static PyObject* pycypher_build_segment(
+  pycypher_StatementStream* self, cypher_parse_segment_t* segment
+) {
+  const cypher_astnode_t* directive = cypher_parse_segment_get_directive(segment);
+  unsigned int nerrors = cypher_parse_segment_nerrors(segment);
+  PyObject* ast;
+  unsigned int i;
+  if(directive == NULL) {
+    Py_INCREF(Py_None);
+    ast = Py_None;
+  } else {
+    pycypher_build_ctx_t ctx = {self->ast_class, PyDict_New()};
+    if(ctx.index == NULL)
+      return NULL;
+    ast = pycypher_build_ast(&ctx, directive);
+    Py_DECREF(ctx.index);
+    if(ast == NULL)
+      return NULL;
+  }
+  PyObject* errors = PyList_New(nerrors);
+  for(i=0; errors != NULL && i<nerrors; ++i) {
+    PyObject* exn = pycypher_build_exn(
+      self->exn_class, cypher_parse_segment_get_error(segment, i)
+    );
+    if(exn == NULL)
+      Py_CLEAR(errors);
+    else
+      PyList_SET_ITEM(errors, i, exn);
+  }
+  if(errors == NULL) {
+    Py_DECREF(ast);
+    return NULL;
+  }
+  return Py_BuildValue("(NN)", ast, errors);
+}
+
+static PyObject* pycypher_StatementStream_next(pycypher_StatementStream* self) {
+  for(;;) {
+    // Without a GIL several threads may call next at once, so the flag is
+    // taken atomically and held until the position is updated.
+    if(__atomic_exchange_n(&self->busy, true, __ATOMIC_ACQUIRE)) {
+      PyErr_SetString(PyExc_ValueError, "statement stream already executing");
+      return NULL;
+    }
+    if(self->done) {
+      __atomic_store_n(&self->busy, false, __ATOMIC_RELEASE);
+      return NULL;
+    }
+    cypher_parse_segment_t* segment;
+    Py_BEGIN_ALLOW_THREADS
+    segment = pycypher_next_segment(self);
+    Py_END_ALLOW_THREADS
+    if(segment == NULL) {
+      self->done = true;
+      __atomic_store_n(&self->busy, false, __ATOMIC_RELEASE);
+      return PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    struct cypher_input_range range = cypher_parse_segment_get_range(segment);
+    bool empty = cypher_parse_segment_get_directive(segment) == NULL &&
+      cypher_parse_segment_nerrors(segment) == 0;
+    // With CYPHER_PARSE_SINGLE the stream ends after the first directive, like
+    // the other parse functions do.
+    if(cypher_parse_segment_is_eof(segment) ||
+        range.end.offset <= self->position.offset ||
+        range.end.offset - self->origin >= self->length ||
+        ((self->flags & CYPHER_PARSE_SINGLE) &&
+          cypher_parse_segment_get_directive(segment) != NULL))
+      self->done = true;
+    // The position is kept up to date even at the end so that it always tells
+    // where the last segment ended.
+    if(range.end.offset > self->position.offset)
+      self->position = range.end;
+    __atomic_store_n(&self->busy, false, __ATOMIC_RELEASE);
+
+    PyObject* result = NULL;
+    // Segments holding nothing but comments or trailing whitespace are
+    // skipped.
+    if(!empty)
+      result = pycypher_build_segment(self, segment);
+    cypher_parse_segment_release(segment);
+    if(!empty)
+      return result;
+  }
+}
+
+static PyObject* pycypher_StatementStream_get_offset(
+  pycypher_StatementStream* self, void* closure
+) {
+  return Py_BuildValue("n", (Py_ssize_t)self->position.offset);
+}
+
+static PyGetSetDef pycypher_StatementStream_getset[] = {
+  {
+    "offset", (getter)pycypher_StatementStream_get_offset, NULL,
+    "Offset at which the last segment parsed ended.", NULL
+  },
+  {NULL}
+};
+
+PyTypeObject pycypher_StatementStreamType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "pycypher.bindings.StatementStream",           /* tp_name */
+  sizeof(pycypher_StatementStream),              /* tp_basicsize */
+  0,                                             /* tp_itemsize */
+  (destructor)pycypher_StatementStream_dealloc,  /* tp_dealloc */
+};
+
+int pycypher_init_stream(void) {
+  pycypher_StatementStreamType.tp_flags = Py_TPFLAGS_DEFAULT;
+  pycypher_StatementStreamType.tp_doc = "Iterator over the directives of a query.";
+  pycypher_StatementStreamType.tp_iter = PyObject_SelfIter;
+  pycypher_StatementStreamType.tp_iternext = (iternextfunc)pycypher_StatementStream_next;
+  pycypher_StatementStreamType.tp_getset = pycypher_StatementStream_getset;
+  return PyType_Ready(&pycypher_StatementStreamType);
+}
+
+PyObject* pycypher_iter_buffer(PyObject* self, PyObject* args) {
+  PyObject* ast_class;
+  PyObject* exn_class;
+  Py_buffer view;
+  const pycypher_parser_options_t* options = pycypher_parser_options(self);
+  Py_ssize_t offset = 0;
+  unsigned int line = options->initial_position.line;
+  unsigned int column = options->initial_position.column;
+  if (!PyArg_ParseTuple(
+      args, "OO" PYCYPHER_BUFFER_FORMAT "|nII:iter_buffer",
+      &ast_class, &exn_class, &view, &offset, &line, &column
+  ))
+    return NULL;
+  if(offset < 0 || offset > view.len) {
+    PyBuffer_Release(&view);
+    PyErr_SetString(PyExc_ValueError, "offset out of range");
+    return NULL;
+  }
+  pycypher_StatementStream* result = pycypher_new_statement_stream(
+    ast_class, exn_class, options
+  );
+  if(result == NULL) {
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+  result->view = view;
+  result->has_view = true;
+  result->data = view.buf;
+  result->length = view.len;
+  result->position.offset = result->origin + offset;
+  result->position.line = line;
+  result->position.column = column;
+  result->done = offset == view.len;
+  return (PyObject*)result;
+}
+
+/* Return a stream over a private mapping of the file, which outlives the
+descriptor, or None if the file can't be mapped (pipes, empty files).
+*/
+PyObject* pycypher_iter_fd(PyObject* self, PyObject* args) {
+  PyObject* ast_class;
+  PyObject* exn_class;
+  int fd;
+  if (!PyArg_ParseTuple(args, "OOi:iter_fd", &ast_class, &exn_class, &fd))
+    return NULL;
+  struct stat st;
+  if(fstat(fd, &st) < 0)
+    return PyErr_SetFromErrno(PyExc_OSError);
+  if(!S_ISREG(st.st_mode) || st.st_size == 0)
+    Py_RETURN_NONE;
+  void* mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(mapping == MAP_FAILED)
+    Py_RETURN_NONE;
+  pycypher_StatementStream* result = pycypher_new_statement_stream(
+    ast_class, exn_class, pycypher_parser_options(self)
+  );
+  if(result == NULL) {
+    munmap(mapping, st.st_size);
+    return NULL;
+  }
+  result->mapping = mapping;
+  result->data = mapping;
+  result->length = st.st_size;
+  return (PyObject*)result;
+}
@@ -0,0 +1,64 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_STREAM_H
+#define PYCYPHER_STREAM_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <Python.h>
+#include <cypher-parser.h>
+
+/* An iterator parsing its input one directive at a time. Every step resumes
+cypher_uparse_each at the end of the previous segment and stops it after the
+next one, so only the current directive's AST exists at any point. Yields
+(ast, errors) tuples, where ast is the CypherAstNode of the directive or None
+if the segment consisted of errors only.
+
+The input is either a buffer, which stays exported for the lifetime of the
+iterator, or a private mapping of a file. A buffer can also be parsed from a
+given position on, with offsets continuing from it, which is how
+ParsedScript re-parses the directives following an edit.
+
+Streams are parsed with the flags, initial position and error colorization
+of the parser options of the function creating them. Since every step moves
+the initial position, each stream has a config of its own; origin is the
+offset the start of the input is reported at.
+*/
+typedef struct {
+  PyObject_HEAD
+  PyObject* ast_class;
+  PyObject* exn_class;
+  Py_buffer view;
+  bool has_view;
+  void* mapping;
+  const char* data;
+  size_t length;
+  struct cypher_input_position position;
+  size_t origin;
+  cypher_parser_config_t* config;
+  uint64_t flags;
+  bool busy;
+  bool done;
+}
+pycypher_StatementStream;
+
+extern PyTypeObject pycypher_StatementStreamType;
+
+/* Ready the type. Return -1 on failure. */
+int pycypher_init_stream(void);
+
+PyObject* pycypher_iter_buffer(PyObject*, PyObject*);
+PyObject* pycypher_iter_fd(PyObject*, PyObject*);
+
+#endif
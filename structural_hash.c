@@ -0,0 +1,172 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "structural_hash.h"
+
+#define PYCYPHER_GOLDEN_RATIO 0x9e3779b97f4a7c15ULL
+
+static uint64_t pycypher_hash_combine(uint64_t hash, uint64_t value) {
+  return hash ^ (value + PYCYPHER_GOLDEN_RATIO + (hash << 6) + (hash >> 2));
+}
+
+/* The splitmix64 finalizer, so that sums of hashes stay well distributed. */
+static uint64_t pycypher_hash_mix(uint64_t hash) {
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+  return hash ^ (hash >> 31);
+}
+
+int pycypher_hash_role(uint64_t* roles, PyObject* role) {
+  Py_hash_t hash = PyObject_Hash(role);
+  if(hash == -1)
+    return -1;
+  *roles += pycypher_hash_mix((uint64_t)hash);
+  return 0;
+}
+
+uint64_t pycypher_hash_child(uint64_t hash, Py_hash_t child, uint64_t roles) {
+  return pycypher_hash_combine(pycypher_hash_combine(hash, (uint64_t)child), roles);
+}
+
+/* Hash a prop value into *result, or return 0 if it doesn't count towards
+the hash: missing strings, empty lists and references to other nodes.
+*/
+static int pycypher_hash_prop_value(PyObject* value, uint64_t* result) {
+  if(value == Py_None || PyDict_Check(value))
+    return 0;
+  if(PyList_Check(value)) {
+    Py_ssize_t n = PyList_GET_SIZE(value);
+    Py_ssize_t i;
+    if(n == 0 || PyDict_Check(PyList_GET_ITEM(value, 0)))
+      return 0;
+    *result = pycypher_hash_combine(PYCYPHER_HASH_SEED, n);
+    for(i=0; i<n; ++i) {
+      Py_hash_t item = PyObject_Hash(PyList_GET_ITEM(value, i));
+      if(item == -1)
+        return -1;
+      *result = pycypher_hash_combine(*result, (uint64_t)item);
+    }
+    return 1;
+  }
+  Py_hash_t hash = PyObject_Hash(value);
+  if(hash == -1)
+    return -1;
+  *result = (uint64_t)hash;
+  return 1;
+}
+
+int pycypher_hash_node(
+  uint64_t children_hash, Py_ssize_t nchildren, PyObject* type,
+  PyObject* props, Py_hash_t* result
+) {
+  PyObject* name;
+  PyObject* value;
+  Py_ssize_t pos = 0;
+  // Props are summed so that their order in the dict doesn't matter.
+  uint64_t props_hash = 0;
+  while(props != NULL && PyDict_Next(props, &pos, &name, &value)) {
+    uint64_t value_hash;
+    int counted = pycypher_hash_prop_value(value, &value_hash);
+    if(counted < 0)
+      return -1;
+    if(!counted)
+      continue;
+    Py_hash_t name_hash = PyObject_Hash(name);
+    if(name_hash == -1)
+      return -1;
+    props_hash += pycypher_hash_mix(pycypher_hash_combine(
+      (uint64_t)name_hash, value_hash
+    ));
+  }
+  Py_hash_t type_hash = PyObject_Hash(type);
+  if(type_hash == -1)
+    return -1;
+  uint64_t hash = pycypher_hash_combine(children_hash, nchildren);
+  hash = pycypher_hash_combine(hash, props_hash);
+  hash = pycypher_hash_mix(pycypher_hash_combine(hash, (uint64_t)type_hash));
+  *result = (Py_hash_t)hash;
+  // -1 is reserved for errors by tp_hash.
+  if(*result == -1)
+    *result = -2;
+  return 0;
+}
+
+/* Add the roles in the sequence to *result. */
+static int pycypher_hash_roles(PyObject* roles, uint64_t* result) {
+  PyObject* seq = PySequence_Fast(roles, "roles must be a sequence");
+  if(seq == NULL)
+    return -1;
+  Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+  Py_ssize_t i;
+  for(i=0; i<n; ++i)
+    if(pycypher_hash_role(result, PySequence_Fast_GET_ITEM(seq, i)) < 0) {
+      Py_DECREF(seq);
+      return -1;
+    }
+  Py_DECREF(seq);
+  return 0;
+}
+
+PyObject* pycypher_structural_hash(PyObject* self, PyObject* args) {
+  PyObject* type;
+  PyObject* props;
+  PyObject* child_hashes;
+  PyObject* child_roles = NULL;
+  PyObject* roles_seq = NULL;
+  if (!PyArg_ParseTuple(
+      args, "OO!O|O:structural_hash", &type, &PyDict_Type, &props,
+      &child_hashes, &child_roles
+  ))
+    return NULL;
+  PyObject* seq = PySequence_Fast(child_hashes, "child hashes must be a sequence");
+  if(seq == NULL)
+    return NULL;
+  Py_ssize_t nchildren = PySequence_Fast_GET_SIZE(seq);
+  if(child_roles != NULL && child_roles != Py_None) {
+    roles_seq = PySequence_Fast(child_roles, "child roles must be a sequence");
+    if(roles_seq == NULL) {
+      Py_DECREF(seq);
+      return NULL;
+    }
+    if(PySequence_Fast_GET_SIZE(roles_seq) != nchildren) {
+      PyErr_SetString(PyExc_ValueError, "one list of roles per child expected");
+      goto error;
+    }
+  }
+  uint64_t hash = PYCYPHER_HASH_SEED;
+  Py_ssize_t i;
+  for(i=0; i<nchildren; ++i) {
+    uint64_t roles = 0;
+    Py_ssize_t child = PyNumber_AsSsize_t(
+      PySequence_Fast_GET_ITEM(seq, i), PyExc_OverflowError
+    );
+    if((child == -1 && PyErr_Occurred()) ||
+        (roles_seq != NULL && pycypher_hash_roles(
+          PySequence_Fast_GET_ITEM(roles_seq, i), &roles
+        ) < 0))
+      goto error;
+    hash = pycypher_hash_child(hash, (Py_hash_t)child, roles);
+  }
+  Py_DECREF(seq);
+  Py_XDECREF(roles_seq);
+  Py_hash_t result;
+  if(pycypher_hash_node(hash, nchildren, type, props, &result) < 0)
+    return NULL;
+  return Py_BuildValue("n", (Py_ssize_t)result);
+
+error:
+  Py_DECREF(seq);
+  Py_XDECREF(roles_seq);
+  return NULL;
+}
@@ -0,0 +1,55 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_STRUCTURAL_HASH_H
+#define PYCYPHER_STRUCTURAL_HASH_H
+#include <stdint.h>
+#include <Python.h>
+
+#if PY_MAJOR_VERSION < 3
+  typedef long Py_hash_t;
+#endif
+
+/* Structural hash of a subtree, computed bottom-up from the Python values
+given to the CypherAstNode constructor so that every way of building a node
+agrees on it: start from PYCYPHER_HASH_SEED, fold in the hash of every child
+in order with pycypher_hash_child, then finish with the type and props of the
+node. Ids and ranges are left out, and AST props only count through the roles
+they give the children, so identical subexpressions hash the same wherever
+they occur while e.g. the skip and limit of a projection stay apart. Roles
+given to deeper descendants are left out, as they depend on more than the
+subtree of the child. Like the hashes of the strings it is made of, the
+result is only stable within a process.
+*/
+#define PYCYPHER_HASH_SEED 0x84222325cbf29ce4ULL
+
+/* Add a role the parent gives the child to *roles, which starts at 0 for a
+child without roles. The order of the roles doesn't matter. Return -1 with an
+exception set if the role isn't hashable.
+*/
+int pycypher_hash_role(uint64_t* roles, PyObject* role);
+
+uint64_t pycypher_hash_child(uint64_t hash, Py_hash_t child, uint64_t roles);
+
+/* props may be NULL for a node without props. Return -1 with an exception
+set if a prop value isn't hashable.
+*/
+int pycypher_hash_node(
+  uint64_t children_hash, Py_ssize_t nchildren, PyObject* type,
+  PyObject* props, Py_hash_t* result
+);
+
+PyObject* pycypher_structural_hash(PyObject*, PyObject*);
+
+#endif
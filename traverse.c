@@ -0,0 +1,232 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "traverse.h"
+
+#if PY_MAJOR_VERSION >= 3
+  #define PYCYPHER_INTERN_STRING PyUnicode_InternFromString
+#else
+  #define PYCYPHER_INTERN_STRING PyString_InternFromString
+#endif
+
+static PyObject* pycypher_children_attr;
+static PyObject* pycypher_type_attr;
+static PyObject* pycypher_instanceof_attr;
+static PyObject* pycypher_roles_attr;
+static PyObject* pycypher_start_attr;
+static PyObject* pycypher_end_attr;
+
+int pycypher_init_traverse(void) {
+  if((pycypher_children_attr = PYCYPHER_INTERN_STRING("_children")) == NULL ||
+      (pycypher_type_attr = PYCYPHER_INTERN_STRING("_type")) == NULL ||
+      (pycypher_instanceof_attr = PYCYPHER_INTERN_STRING("_instanceof")) == NULL ||
+      (pycypher_roles_attr = PYCYPHER_INTERN_STRING("_roles")) == NULL ||
+      (pycypher_start_attr = PYCYPHER_INTERN_STRING("_start")) == NULL ||
+      (pycypher_end_attr = PYCYPHER_INTERN_STRING("_end")) == NULL)
+    return -1;
+  return 0;
+}
+
+typedef struct {
+  PyObject* type;
+  PyObject* instanceof;
+  PyObject* role;
+  PyObject* start;
+  PyObject* end;
+  PyObject* prune;
+  PyObject* callback;
+  PyObject* matches;
+  Py_ssize_t nmatches;
+  bool stopped;
+}
+pycypher_traversal_t;
+
+/* A node on the stack along with its children and the next one to visit. */
+typedef struct {
+  PyObject* node;
+  PyObject* children;
+  Py_ssize_t next_child;
+}
+pycypher_traversal_frame_t;
+
+/* Return 1 if the attribute of the node compares to the value with op, 0 if
+it doesn't and -1 on error.
+*/
+static int pycypher_compare_attr(
+  PyObject* node, PyObject* attr, PyObject* value, int op
+) {
+  PyObject* actual = PyObject_GetAttr(node, attr);
+  if(actual == NULL)
+    return -1;
+  // Type names are interned on both sides, so most checks end here.
+  int result = op == Py_EQ && actual == value
+    ? 1
+    : PyObject_RichCompareBool(actual, value, op);
+  Py_DECREF(actual);
+  return result;
+}
+
+static int pycypher_attr_contains(PyObject* node, PyObject* attr, PyObject* value) {
+  PyObject* container = PyObject_GetAttr(node, attr);
+  if(container == NULL)
+    return -1;
+  int result = PySequence_Contains(container, value);
+  Py_DECREF(container);
+  return result;
+}
+
+/* Return 1 if the subtree of the node can't contain any node within the
+range, 0 if it can and -1 on error. Children lie within the range of their
+parent.
+*/
+static int pycypher_outside_range(pycypher_traversal_t* t, PyObject* node) {
+  int result = 0;
+  if(t->start != Py_None)
+    result = pycypher_compare_attr(node, pycypher_end_attr, t->start, Py_LT);
+  if(result == 0 && t->end != Py_None)
+    result = pycypher_compare_attr(node, pycypher_start_attr, t->end, Py_GT);
+  return result;
+}
+
+static int pycypher_matches(pycypher_traversal_t* t, PyObject* node) {
+  int result = 1;
+  if(result == 1 && t->type != Py_None)
+    result = pycypher_compare_attr(node, pycypher_type_attr, t->type, Py_EQ);
+  if(result == 1 && t->instanceof != Py_None)
+    result = pycypher_attr_contains(node, pycypher_instanceof_attr, t->instanceof);
+  if(result == 1 && t->role != Py_None)
+    result = pycypher_attr_contains(node, pycypher_roles_attr, t->role);
+  if(result == 1 && t->start != Py_None)
+    result = pycypher_compare_attr(node, pycypher_start_attr, t->start, Py_GE);
+  if(result == 1 && t->end != Py_None)
+    result = pycypher_compare_attr(node, pycypher_end_attr, t->end, Py_LE);
+  return result;
+}
+
+static int pycypher_visit(pycypher_traversal_t* t, PyObject* node) {
+  int matches = pycypher_matches(t, node);
+  if(matches <= 0)
+    return matches;
+  ++t->nmatches;
+  if(t->callback == Py_None)
+    return PyList_Append(t->matches, node);
+  PyObject* result = PyObject_CallFunctionObjArgs(t->callback, node, NULL);
+  if(result == NULL)
+    return -1;
+  t->stopped = PyObject_IsTrue(result) == 1;
+  Py_DECREF(result);
+  return 0;
+}
+
+/* Push the node unless it's pruned; visit it first in pre-order. Return -1 on
+error.
+*/
+static int pycypher_push(
+  pycypher_traversal_t* t, pycypher_traversal_frame_t** stack,
+  size_t* depth, size_t* capacity, PyObject* node, bool post_order
+) {
+  int skip = pycypher_outside_range(t, node);
+  if(skip != 0)
+    return skip < 0 ? -1 : 0;
+  if(!post_order && pycypher_visit(t, node) < 0)
+    return -1;
+  PyObject* children = NULL;
+  if(t->prune != Py_None) {
+    PyObject* pruned = PyObject_CallFunctionObjArgs(t->prune, node, NULL);
+    if(pruned == NULL)
+      return -1;
+    skip = PyObject_IsTrue(pruned);
+    Py_DECREF(pruned);
+    if(skip < 0)
+      return -1;
+  }
+  if(!skip) {
+    children = PyObject_GetAttr(node, pycypher_children_attr);
+    if(children == NULL)
+      return -1;
+    PyObject* seq = PySequence_Fast(children, "_children must be a sequence");
+    Py_DECREF(children);
+    if((children = seq) == NULL)
+      return -1;
+  }
+  if(*depth == *capacity) {
+    size_t new_capacity = *capacity ? *capacity * 2 : 32;
+    pycypher_traversal_frame_t* resized = PyMem_Realloc(
+      *stack, new_capacity * sizeof(pycypher_traversal_frame_t)
+    );
+    if(resized == NULL) {
+      Py_XDECREF(children);
+      PyErr_NoMemory();
+      return -1;
+    }
+    *stack = resized;
+    *capacity = new_capacity;
+  }
+  Py_INCREF(node);
+  (*stack)[*depth].node = node;
+  (*stack)[*depth].children = children;
+  (*stack)[*depth].next_child = 0;
+  ++*depth;
+  return 0;
+}
+
+PyObject* pycypher_traverse_nodes(PyObject* self, PyObject* args) {
+  PyObject* root;
+  int post_order;
+  pycypher_traversal_t t;
+  memset(&t, 0, sizeof(t));
+  if (!PyArg_ParseTuple(
+      args, "OOOOOOiOO:traverse", &root, &t.type, &t.instanceof, &t.role,
+      &t.start, &t.end, &post_order, &t.prune, &t.callback
+  ))
+    return NULL;
+  if(t.callback == Py_None && (t.matches = PyList_New(0)) == NULL)
+    return NULL;
+
+  pycypher_traversal_frame_t* stack = NULL;
+  size_t depth = 0;
+  size_t capacity = 0;
+  int error = pycypher_push(&t, &stack, &depth, &capacity, root, post_order);
+  while(!error && !t.stopped && depth > 0) {
+    pycypher_traversal_frame_t* top = &stack[depth - 1];
+    if(top->children != NULL &&
+        top->next_child < PySequence_Fast_GET_SIZE(top->children)) {
+      PyObject* child = PySequence_Fast_GET_ITEM(
+        top->children, top->next_child++
+      );
+      error = pycypher_push(&t, &stack, &depth, &capacity, child, post_order);
+      continue;
+    }
+    PyObject* node = top->node;
+    Py_XDECREF(top->children);
+    --depth;
+    if(post_order)
+      error = pycypher_visit(&t, node);
+    Py_DECREF(node);
+  }
+  while(depth > 0) {
+    --depth;
+    Py_DECREF(stack[depth].node);
+    Py_XDECREF(stack[depth].children);
+  }
+  PyMem_Free(stack);
+
+  if(error) {
+    Py_XDECREF(t.matches);
+    return NULL;
+  }
+  if(t.callback == Py_None)
+    return t.matches;
+  return PyLong_FromSsize_t(t.nmatches);
+}
@@ -0,0 +1,33 @@
+/* Copyright 2017, Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PYCYPHER_TRAVERSE_H
+#define PYCYPHER_TRAVERSE_H
+#include <stdbool.h>
+#include <Python.h>
+
+/* Intern the attribute names read from nodes. Return -1 on failure. */
+int pycypher_init_traverse(void);
+
+/* traverse(root, type, instanceof, role, start, end, post_order, prune,
+callback) walks the subtree of a CypherAstNode with an explicit stack, reading
+only the attributes set by CypherAstNode.__init__. Any filter may be None.
+Subtrees are skipped when prune(node) is true or when they lie outside the
+[start, end] range. Return the list of matching nodes, or, with a callback,
+call it on every match (stopping once it returns a true value) and return the
+number of matches.
+*/
+PyObject* pycypher_traverse_nodes(PyObject*, PyObject*);
+
+#endif